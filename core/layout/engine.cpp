@@ -6,11 +6,92 @@
  */
 
 #include "engine.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <functional>
+#include <mutex>
 
 namespace obsidian::layout {
 
+/**
+ * State of one layout pass, shared by the recursive layout steps
+ */
+struct LayoutPass {
+    explicit LayoutPass(const LayoutOptions& options)
+        : options(options), counting(options.stats != nullptr) {}
+    
+    const LayoutOptions& options;
+    
+    // Batched measurement: cache misses queued this round
+    std::mutex requestsMutex;
+    std::vector<MeasureRequest> requests;
+    std::atomic<size_t> missCount{0};
+    size_t round = 0;
+    
+    // Statistics, counted only when requested. Pool tasks count too,
+    // hence relaxed atomics.
+    enum Counter {
+        NodesVisited,
+        NodesSkipped,
+        MeasureCalls,
+        MeasureCacheHits,
+        MeasureCacheMisses,
+        Allocations,
+        CounterCount
+    };
+    bool counting;
+    std::atomic<size_t> counters[CounterCount] = {};
+    std::atomic<size_t> maxDepth{0};
+    
+    void count(Counter counter, size_t amount = 1) {
+        if (counting) counters[counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+    
+    void reachDepth(size_t depth) {
+        if (!counting) return;
+        size_t deepest = maxDepth.load(std::memory_order_relaxed);
+        while (depth > deepest &&
+               !maxDepth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed)) {
+        }
+    }
+    
+    void report(LayoutStats& stats, std::chrono::steady_clock::time_point start) const {
+        stats.nodesVisited = counters[NodesVisited];
+        stats.nodesSkipped = counters[NodesSkipped];
+        stats.measureCalls = counters[MeasureCalls];
+        stats.measureCacheHits = counters[MeasureCacheHits];
+        stats.measureCacheMisses = counters[MeasureCacheMisses];
+        stats.maxDepth = maxDepth;
+        stats.allocations = counters[Allocations];
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        stats.wallTimeMs = elapsed.count();
+    }
+};
+
+// Per-node counters, compiled in with OBSIDIAN_LAYOUT_NODE_STATS
+#ifdef OBSIDIAN_LAYOUT_NODE_STATS
+#define OBSIDIAN_NODE_STAT(node, counter) (++(node)->layoutStats_.counter)
+#else
+#define OBSIDIAN_NODE_STAT(node, counter) ((void)(node))
+#endif
+
+void LayoutEngine::countVisit(LayoutNode* node, LayoutPass& pass) {
+    pass.count(LayoutPass::NodesVisited);
+    OBSIDIAN_NODE_STAT(node, layouts);
+}
+
+void LayoutEngine::countSkip(LayoutNode* node, LayoutPass& pass) {
+    pass.count(LayoutPass::NodesSkipped);
+    OBSIDIAN_NODE_STAT(node, reuses);
+}
+
+// Rounds of batched measurement before remaining misses are measured
+// one at a time, in case constraints keep changing between rounds
+static constexpr size_t kMaxMeasureRounds = 4;
+
 // Helper to get padding for a node
 static void getPadding(const Style& style, float parentWidth, float parentHeight,
                        float& left, float& top, float& right, float& bottom) {
@@ -20,90 +101,1622 @@ static void getPadding(const Style& style, float parentWidth, float parentHeight
     bottom = style.padding[3].resolve(parentHeight);
 }
 
-void LayoutEngine::calculateLayout(LayoutNode* root,
-                                    float availableWidth,
-                                    float availableHeight) {
-    if (!root) return;
+// Helper to resolve a root dimension from its style and constraint
+static float resolveDimension(const LayoutValue& size,
+                              const LayoutValue& minSize,
+                              const LayoutValue& maxSize,
+                              float available, MeasureMode mode) {
+    float resolved = 0.0f;
+    if (size.isDefined()) {
+        resolved = size.resolve(available);
+    } else if (mode == MeasureMode::Exactly) {
+        resolved = available;
+    } else if (mode == MeasureMode::AtMost) {
+        resolved = available;  // Start with max, may shrink
+    }
+    
+    // Apply min/max constraints
+    if (minSize.isDefined()) {
+        resolved = std::max(resolved, minSize.resolve(available));
+    }
+    if (maxSize.isDefined()) {
+        resolved = std::min(resolved, maxSize.resolve(available));
+    }
+    return resolved;
+}
+
+// Helper to resolve a child's cross axis alignment (alignSelf overrides alignItems)
+static AlignItems resolveAlignment(AlignItems alignItems, AlignSelf alignSelf) {
+    switch (alignSelf) {
+        case AlignSelf::FlexStart: return AlignItems::FlexStart;
+        case AlignSelf::FlexEnd: return AlignItems::FlexEnd;
+        case AlignSelf::Center: return AlignItems::Center;
+        case AlignSelf::Stretch: return AlignItems::Stretch;
+        default: return alignItems;
+    }
+}
+
+// Helper to compute justifyContent spacing when no child grows:
+// space before the first child and extra space between children
+static void resolveJustifySpacing(JustifyContent justify, float remainingSpace,
+                                  size_t childCount,
+                                  float& leadingSpace, float& interItemSpace) {
+    leadingSpace = 0.0f;
+    interItemSpace = 0.0f;
+    if (remainingSpace <= 0) return;
+    
+    switch (justify) {
+        case JustifyContent::FlexEnd:
+            leadingSpace = remainingSpace;
+            break;
+        case JustifyContent::Center:
+            leadingSpace = remainingSpace / 2.0f;
+            break;
+        case JustifyContent::SpaceBetween:
+            // No initial offset, space distributed between
+            break;
+        case JustifyContent::SpaceAround:
+            leadingSpace = remainingSpace / (childCount * 2);
+            break;
+        case JustifyContent::SpaceEvenly:
+            leadingSpace = remainingSpace / (childCount + 1);
+            break;
+        default:
+            break;
+    }
+    
+    if (childCount > 1) {
+        switch (justify) {
+            case JustifyContent::SpaceBetween:
+                interItemSpace = remainingSpace / (childCount - 1);
+                break;
+            case JustifyContent::SpaceAround:
+                interItemSpace = remainingSpace / childCount;
+                break;
+            case JustifyContent::SpaceEvenly:
+                interItemSpace = remainingSpace / (childCount + 1);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Helper to compute the frame of an absolutely positioned child
+static void resolveAbsoluteFrame(const LayoutValue& styleWidth, const LayoutValue& styleHeight,
+                                 const LayoutValue* position, const LayoutResult& parentLayout,
+                                 LayoutResult& childLayout) {
+    // Calculate size
+    float width = styleWidth.resolve(parentLayout.width);
+    float height = styleHeight.resolve(parentLayout.height);
+    
+    // Calculate position
+    float left = 0.0f;
+    float top = 0.0f;
+    
+    if (position[0].isDefined()) {  // left
+        left = position[0].resolve(parentLayout.width);
+    } else if (position[2].isDefined()) {  // right
+        left = parentLayout.width - width - position[2].resolve(parentLayout.width);
+    }
+    
+    if (position[1].isDefined()) {  // top
+        top = position[1].resolve(parentLayout.height);
+    } else if (position[3].isDefined()) {  // bottom
+        top = parentLayout.height - height - position[3].resolve(parentLayout.height);
+    }
+    
+    childLayout.left = left;
+    childLayout.top = top;
+    childLayout.width = width;
+    childLayout.height = height;
+}
+
+static void resolveAbsoluteFrame(const Style& childStyle, const LayoutResult& parentLayout,
+                                 LayoutResult& childLayout) {
+    resolveAbsoluteFrame(childStyle.width, childStyle.height, childStyle.position,
+                         parentLayout, childLayout);
+}
+
+// Helper to tell whether laying out a nested container can change its size
+// along the parent's main axis. When it can't, the siblings after it don't
+// depend on its subtree and the two can be laid out independently.
+static bool hasFixedMainSize(const LayoutNode* child, bool parentIsColumn) {
+    const Style& style = child->getStyle();
+    const LayoutResult& layout = child->getLayout();
+    if (style.display == Display::Grid) {
+        // Grids grow to their rows, and to their columns only when unsized
+        return parentIsColumn
+            ? style.height.isDefined()
+            : layout.width - layout.paddingLeft - layout.paddingRight > 0;
+    }
+    
+    bool childIsColumn = (style.flexDirection == FlexDirection::Column ||
+                          style.flexDirection == FlexDirection::ColumnReverse);
+    
+    if (childIsColumn == parentIsColumn) {
+        // Child's own main axis: grows to fit its content unless sized
+        return parentIsColumn ? style.height.isDefined() : style.width.isDefined();
+    }
+    
+    // Child's cross axis: taken from its children only when it has no content size
+    float contentSize = parentIsColumn
+        ? layout.height - layout.paddingTop - layout.paddingBottom
+        : layout.width - layout.paddingLeft - layout.paddingRight;
+    return contentSize > 0;
+}
+
+// Helper to count a subtree's nodes, stopping once limit is reached
+static size_t countNodes(const LayoutNode* root, size_t limit) {
+    size_t count = 0;
+    for (const LayoutNode* node = root; node && count < limit; node = node->nextInPreOrder(root)) {
+        ++count;
+    }
+    return count;
+}
+
+// Cell of a grid item, in tracks
+struct GridCell {
+    size_t column = 0;
+    size_t row = 0;
+    size_t columnSpan = 1;
+    size_t rowSpan = 1;
+};
+
+// Row-major auto-placement. Placing the same items in the same order
+// always yields the same cells, so each grid pass places the items again
+// instead of storing their cells. Cells covered by an item spanning rows
+// are not skipped.
+struct GridPlacement {
+    explicit GridPlacement(size_t columnCount) : columnCount(columnCount) {}
+    
+    size_t columnCount;
+    size_t row = 0;
+    size_t column = 0;
+    
+    GridCell place(const Style& item) {
+        GridCell cell;
+        cell.columnSpan = std::clamp<size_t>(item.gridColumnSpan, 1, columnCount);
+        cell.rowSpan = std::max<size_t>(item.gridRowSpan, 1);
+        size_t lastColumn = columnCount - cell.columnSpan;
+        
+        if (item.gridRow > 0) {
+            // Explicit row; doesn't move the cursor
+            cell.row = item.gridRow - 1u;
+            cell.column = item.gridColumn > 0 ? std::min<size_t>(item.gridColumn - 1u, lastColumn) : 0;
+            return cell;
+        }
+        
+        if (item.gridColumn > 0) {
+            size_t wanted = std::min<size_t>(item.gridColumn - 1u, lastColumn);
+            if (wanted < column) ++row;
+            column = wanted;
+        } else if (column + cell.columnSpan > columnCount) {
+            ++row;
+            column = 0;
+        }
+        cell.row = row;
+        cell.column = column;
+        column += cell.columnSpan;
+        return cell;
+    }
+};
+
+// Track definition at an index; tracks past the definitions are auto
+static GridTrack gridTrackAt(std::span<const GridTrack> tracks, size_t index) {
+    return index < tracks.size() ? tracks[index] : GridTrack::auto_();
+}
+
+// Helper to size the tracks of one grid axis in a single pass: fixed
+// tracks take their size, auto tracks the largest item contribution
+// already in `sizes`, and fractional tracks share what is left. Fills
+// in the track offsets and returns the extent of all tracks and gaps.
+static float sizeGridTracks(std::span<const GridTrack> tracks, size_t count,
+                            float available, float gap,
+                            float* sizes, float* offsets) {
+    float used = gap * (count - 1);
+    float totalFraction = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        GridTrack track = gridTrackAt(tracks, i);
+        if (track.type == GridTrackType::Fixed) {
+            sizes[i] = std::max(0.0f, track.value);
+        } else if (track.type == GridTrackType::Fraction) {
+            sizes[i] = 0.0f;
+            totalFraction += std::max(0.0f, track.value);
+        }
+        used += sizes[i];
+    }
+    
+    float remainingSpace = available - used;
+    if (totalFraction > 0 && remainingSpace > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            GridTrack track = gridTrackAt(tracks, i);
+            if (track.type == GridTrackType::Fraction) {
+                sizes[i] = std::max(0.0f, track.value) * remainingSpace / totalFraction;
+            }
+        }
+    }
+    
+    float offset = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i] = offset;
+        offset += sizes[i] + gap;
+    }
+    return offset - gap;
+}
+
+// Helper to get the extent of `span` tracks starting at `first`, gaps included
+static float gridSpanExtent(const float* sizes, const float* offsets, size_t first, size_t span) {
+    size_t last = first + span - 1;
+    return offsets[last] + sizes[last] - offsets[first];
+}
+
+// Per-thread stack of grid track sizes and offsets. A nested grid pushes
+// its tracks above its parent's and pops them before returning, so grid
+// layout doesn't allocate once the stack has grown. Pointers into it are
+// only valid until the next nested layout call.
+static thread_local std::vector<float> gridTrackStack;
+
+struct GridTrackFrame {
+    GridTrackFrame(size_t columns, size_t rows)
+        : base(gridTrackStack.size()), columns(columns), rows(rows) {
+        gridTrackStack.resize(base + 2 * (columns + rows), 0.0f);
+    }
+    ~GridTrackFrame() { gridTrackStack.resize(base); }
+    
+    float* columnSizes() const { return gridTrackStack.data() + base; }
+    float* columnOffsets() const { return columnSizes() + columns; }
+    float* rowSizes() const { return columnOffsets() + columns; }
+    float* rowOffsets() const { return rowSizes() + rows; }
+    
+    size_t base;
+    size_t columns;
+    size_t rows;
+};
+
+void LayoutEngine::calculateLayout(LayoutNode* root,
+                                    float availableWidth,
+                                    float availableHeight,
+                                    const LayoutOptions& options) {
+    if (!root) return;
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    // Start layout from root with given constraints. When batching
+    // measurements, repeat until every measurement came from the cache.
+    LayoutPass pass(options);
+    do {
+        layoutNode(root, availableWidth, MeasureMode::Exactly,
+                   availableHeight, MeasureMode::Exactly, pass);
+    } while (measurePending(pass));
+    
+    if (options.stats) pass.report(*options.stats, start);
+}
+
+void LayoutEngine::layoutNode(LayoutNode* node,
+                               float availableWidth, MeasureMode widthMode,
+                               float availableHeight, MeasureMode heightMode,
+                               LayoutPass& pass) {
+    if (!node) return;
+    
+    LayoutConstraints constraints{availableWidth, widthMode, availableHeight, heightMode};
+    if (reuseRootLayout(node, constraints, pass)) return;
+    
+    size_t misses = pass.missCount;
+    beginNode(node, constraints, pass);
+    
+    // 4. Layout children if this is a container
+    if (node->getChildCount() > 0) {
+        const LayoutResult& layout = node->getLayout();
+        layoutFlexContainer(node, layout.width, MeasureMode::Exactly,
+                           layout.height, MeasureMode::Exactly, pass);
+    }
+    finishNode(node, constraints, misses, pass);
+}
+
+bool LayoutEngine::reuseRootLayout(LayoutNode* node, const LayoutConstraints& constraints,
+                                    LayoutPass& pass) {
+    // Only a true root can reuse its previous layout. A subtree laid out on
+    // its own is sized differently than its parent would size it.
+    if (node->getParent()) return false;
+    
+    // When only relayout boundaries below the root changed, lay those out on
+    // their own. One whose size changes after all dirties its ancestors,
+    // possibly up to another boundary, so repeat until none is left.
+    if (node->cache_.hasLayout && node->cache_.layoutConstraints == constraints) {
+        size_t misses = pass.missCount;
+        while (node->hasDirtyDescendant_ && !node->isDirty_) {
+            layoutDirtyBoundaries(node, pass);
+            if (pass.missCount != misses) {
+                return true;  // Measure the batch, then try again
+            }
+        }
+    }
+    
+    if (canReuseLayout(node, constraints)) {
+        restoreCachedLayout(node);
+        countSkip(node, pass);
+        return true;
+    }
+    return false;
+}
+
+void LayoutEngine::beginNode(LayoutNode* node, const LayoutConstraints& constraints,
+                              LayoutPass& pass) {
+    const Style& style = *node->style_;
+    LayoutResult& layout = node->getMutableLayout();
+    
+    // 1. Resolve width
+    float resolvedWidth = resolveDimension(style.width, style.minWidth, style.maxWidth,
+                                           constraints.width, constraints.widthMode);
+    
+    // 2. Resolve height
+    float resolvedHeight = resolveDimension(style.height, style.minHeight, style.maxHeight,
+                                            constraints.height, constraints.heightMode);
+    
+    // Store dimensions
+    layout.width = resolvedWidth;
+    layout.height = resolvedHeight;
+    
+    // 3. Resolve padding
+    getPadding(style, resolvedWidth, resolvedHeight,
+               layout.paddingLeft, layout.paddingTop,
+               layout.paddingRight, layout.paddingBottom);
+    
+    if (node->getChildCount() == 0) {
+        if (node->hasMeasureFunc()) {
+            // Leaf node with measure function - measure it
+            Size measured = measureLeaf(node, resolvedWidth, constraints.widthMode,
+                                        resolvedHeight, constraints.heightMode, pass);
+            layout.width = measured.width;
+            layout.height = measured.height;
+        }
+        countVisit(node, pass);
+    }
+}
+
+void LayoutEngine::finishNode(LayoutNode* node, const LayoutConstraints& constraints,
+                               size_t misses, LayoutPass& pass) {
+    // 5. Layout absolute positioned children
+    layoutAbsoluteChildren(node, pass);
+    
+    if (!node->getParent()) {
+        if (pass.missCount == misses) {
+            storeCachedLayout(node, constraints);
+        }
+    } else {
+        // The parent's next pass must lay this subtree out again
+        node->cache_.hasLayout = false;
+        node->isDirty_ = false;
+        node->getParent()->markDirty(DirtyReason::Relayout);
+    }
+}
+
+void LayoutEngine::layoutChildContainer(LayoutNode* node,
+                                         float availableWidth, MeasureMode widthMode,
+                                         float availableHeight, MeasureMode heightMode,
+                                         LayoutPass& pass, size_t depth) {
+    LayoutConstraints constraints{availableWidth, widthMode, availableHeight, heightMode};
+    if (canReuseLayout(node, constraints)) {
+        restoreCachedLayout(node);
+        countSkip(node, pass);
+        return;
+    }
+    layoutContainers(node, constraints, true, pass, depth);
+}
+
+bool LayoutEngine::layoutBoundary(LayoutNode* node, const LayoutOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    
+    LayoutPass pass(options);
+    bool laidOut = false;
+    do {
+        laidOut = layoutBoundary(node, pass);
+    } while (measurePending(pass));
+    
+    if (laidOut) {
+        // Nothing above it needs layout now, unless another boundary does
+        node->unflagAncestorsForRelayout();
+    }
+    
+    if (options.stats) pass.report(*options.stats, start);
+    return laidOut;
+}
+
+bool LayoutEngine::layoutBoundary(LayoutNode* node, LayoutPass& pass) {
+    // A boundary dirtied from below keeps its cache; dirtying it directly clears it
+    if (!node || !node->getParent() || !node->isDirty_ ||
+        !node->cache_.hasLayout || !node->isRelayoutBoundary()) {
+        return false;
+    }
+    
+    LayoutConstraints constraints = node->cache_.layoutConstraints;
+    LayoutResult& layout = node->getMutableLayout();
+    
+    // A boundary enters its layout at exactly the size it is constrained to
+    layout.width = constraints.width;
+    layout.height = constraints.height;
+    
+    size_t misses = pass.missCount;
+    layoutFlexContainer(node, constraints.width, constraints.widthMode,
+                        constraints.height, constraints.heightMode, pass);
+    if (pass.missCount != misses) {
+        // Laid out with provisional measurements; stay dirty for the next round
+        node->flagAncestorsForRelayout();
+        return false;
+    }
+    
+    // The cache still holds the size from the previous pass
+    const LayoutResult& previous = node->cache_.layout;
+    bool sizeChanged = (layout.width != previous.width || layout.height != previous.height);
+    storeCachedLayout(node, constraints);
+    
+    if (sizeChanged) {
+        // Its content changed its size after all; the parent must adjust
+        node->getParent()->markDirty(DirtyReason::Relayout);
+        return false;
+    }
+    return true;
+}
+
+void LayoutEngine::layoutDirtyBoundaries(LayoutNode* node, LayoutPass& pass) {
+    node->hasDirtyDescendant_ = false;
+    
+    // Descend only through clean nodes that lead to a dirty boundary
+    LayoutNode* current = node->nextInPreOrder(node);
+    while (current) {
+        if (current->isDirty_) {
+            layoutBoundary(current, pass);
+            current = current->nextInPreOrder(node, false);
+        } else if (current->hasDirtyDescendant_) {
+            current->hasDirtyDescendant_ = false;
+            current = current->nextInPreOrder(node);
+        } else {
+            current = current->nextInPreOrder(node, false);
+        }
+    }
+}
+
+Size LayoutEngine::measureLeaf(LayoutNode* node,
+                                float width, MeasureMode widthMode,
+                                float height, MeasureMode heightMode,
+                                LayoutPass& pass) {
+    LayoutConstraints constraints{width, widthMode, height, heightMode};
+    if (!pass.options.batchMeasure && !node->measureProvider_->measureBatch) {
+        if (pass.counting) {
+            // LayoutNode::measure checks the cache itself; look first to count
+            bool cached = node->cache_.findMeasurement(constraints) != nullptr;
+            pass.count(cached ? LayoutPass::MeasureCacheHits : LayoutPass::MeasureCacheMisses);
+            pass.count(LayoutPass::MeasureCalls, cached ? 0 : 1);
+        }
+        return node->measure(width, widthMode, height, heightMode);
+    }
+    
+    if (const Size* cached = node->cache_.findMeasurement(constraints)) {
+        pass.count(LayoutPass::MeasureCacheHits);
+        return *cached;
+    }
+    pass.count(LayoutPass::MeasureCacheMisses);
+    
+    if (pass.round >= kMaxMeasureRounds) {
+        // Still missing after several rounds; measure this one right away
+        MeasureRequest request{node, constraints, {}};
+        measureBatch(&request, 1, pass.options);
+        node->cache_.addMeasurement(constraints, request.result);
+        pass.count(LayoutPass::MeasureCalls);
+        return request.result;
+    }
+    
+    // Queue it and lay out with an empty size for now
+    {
+        std::lock_guard<std::mutex> lock(pass.requestsMutex);
+        size_t capacity = pass.requests.capacity();
+        pass.requests.push_back({node, constraints, {}});
+        pass.count(LayoutPass::Allocations, pass.requests.capacity() != capacity ? 1 : 0);
+    }
+    ++pass.missCount;
+    return {0.0f, 0.0f};
+}
+
+// Provider that measures a request's whole kind at once, or nullptr when
+// the request goes to LayoutOptions::batchMeasure
+static const MeasureProvider* batchingProvider(const MeasureRequest& request) {
+    const MeasureProvider* provider = request.node->getMeasureProvider();
+    return provider->measureBatch ? provider : nullptr;
+}
+
+void LayoutEngine::measureBatch(MeasureRequest* requests, size_t count,
+                                const LayoutOptions& options) {
+    if (const MeasureProvider* provider = batchingProvider(requests[0])) {
+        provider->measureBatch(requests, count);
+    } else {
+        options.batchMeasure(requests, count);
+    }
+}
+
+bool LayoutEngine::measurePending(LayoutPass& pass) {
+    ++pass.round;
+    if (pass.requests.empty()) return false;
+    
+    // One call per kind of leaf: group the requests by batching provider,
+    // keeping their order within each group
+    std::vector<MeasureRequest>& requests = pass.requests;
+    std::stable_sort(requests.begin(), requests.end(),
+                     [](const MeasureRequest& a, const MeasureRequest& b) {
+                         return std::less<const MeasureProvider*>()(batchingProvider(a),
+                                                                    batchingProvider(b));
+                     });
+    for (size_t first = 0; first < requests.size();) {
+        size_t last = first + 1;
+        while (last < requests.size() &&
+               batchingProvider(requests[last]) == batchingProvider(requests[first])) {
+            ++last;
+        }
+        measureBatch(requests.data() + first, last - first, pass.options);
+        first = last;
+    }
+    
+    for (const MeasureRequest& request : requests) {
+        request.node->cache_.addMeasurement(request.constraints, request.result);
+        OBSIDIAN_NODE_STAT(request.node, measureCalls);
+    }
+    pass.count(LayoutPass::MeasureCalls, requests.size());
+    requests.clear();
+    return true;
+}
+
+bool LayoutEngine::canReuseLayout(const LayoutNode* node, const LayoutConstraints& constraints) {
+    return !node->isDirty_ && !node->hasDirtyDescendant_ && node->cache_.hasLayout &&
+           node->cache_.layoutConstraints == constraints;
+}
+
+void LayoutEngine::restoreCachedLayout(LayoutNode* node) {
+    // Position is owned by the parent; only size and padding are reused.
+    // Descendants still hold the results of the cached pass.
+    const LayoutResult& cached = node->cache_.layout;
+    LayoutResult& layout = node->getMutableLayout();
+    layout.width = cached.width;
+    layout.height = cached.height;
+    layout.paddingLeft = cached.paddingLeft;
+    layout.paddingTop = cached.paddingTop;
+    layout.paddingRight = cached.paddingRight;
+    layout.paddingBottom = cached.paddingBottom;
+}
+
+void LayoutEngine::storeCachedLayout(LayoutNode* node, const LayoutConstraints& constraints) {
+    node->cache_.layoutConstraints = constraints;
+    node->cache_.layout = node->getLayout();
+    node->cache_.hasLayout = true;
+    node->isDirty_ = false;
+    node->hasDirtyDescendant_ = false;
+}
+
+/**
+ * Grid access to a LayoutNode container and its children
+ */
+struct LayoutEngine::NodeGridAccess {
+    LayoutNode* node;
+    LayoutPass& pass;
+    size_t depth;
+    
+    template <typename Visit>
+    void forEachFlowChild(Visit&& visit) const {
+        for (auto* child : node->getChildren()) {
+            if (child->style_->positionType == PositionType::Relative) {
+                visit(child);
+            }
+        }
+    }
+    
+    const Style& style(LayoutNode* child) const { return *child->style_; }
+    LayoutResult& layout(LayoutNode* child) const { return child->getMutableLayout(); }
+    bool hasChildren(LayoutNode* child) const { return child->getChildCount() > 0; }
+    bool hasMeasureFunc(LayoutNode* child) const { return child->hasMeasureFunc(); }
+    
+    Size measure(LayoutNode* child, float width, MeasureMode widthMode,
+                 float height, MeasureMode heightMode) const {
+        return measureLeaf(child, width, widthMode, height, heightMode, pass);
+    }
+    
+    void layoutContainer(LayoutNode* child, float width, MeasureMode widthMode,
+                         float height, MeasureMode heightMode) const {
+        layoutChildContainer(child, width, widthMode, height, heightMode, pass, depth + 1);
+    }
+    
+    void finishLeaf(LayoutNode* child) const {
+        child->isDirty_ = false;
+        countVisit(child, pass);
+    }
+    
+    void countAllocation() const { pass.count(LayoutPass::Allocations); }
+};
+
+/**
+ * Grid access to a LayoutTree container and its children
+ */
+struct LayoutEngine::TreeGridAccess {
+    LayoutTree& tree;
+    NodeId node;
+    
+    template <typename Visit>
+    void forEachFlowChild(Visit&& visit) const {
+        for (NodeId child = tree.getFirstChild(node); child != kInvalidNodeId;
+             child = tree.getNextSibling(child)) {
+            if (tree.getCompactStyle(child).getPositionType() == PositionType::Relative) {
+                visit(child);
+            }
+        }
+    }
+    
+    Style style(NodeId child) const { return tree.getStyle(child); }
+    LayoutResult& layout(NodeId child) const { return tree.getMutableLayout(child); }
+    bool hasChildren(NodeId child) const { return tree.getChildCount(child) > 0; }
+    bool hasMeasureFunc(NodeId child) const { return tree.hasMeasureFunc(child); }
+    
+    Size measure(NodeId child, float width, MeasureMode widthMode,
+                 float height, MeasureMode heightMode) const {
+        return tree.measure(child, width, widthMode, height, heightMode);
+    }
+    
+    void layoutContainer(NodeId child, float, MeasureMode, float, MeasureMode) const {
+        layoutTreeFlexContainer(tree, child);
+    }
+    
+    void finishLeaf(NodeId) const {}
+    void countAllocation() const {}
+};
+
+template <typename Access>
+void LayoutEngine::layoutGridContainer(const Access& access, const Style& style,
+                                       LayoutResult& layout) {
+    float contentWidth = std::max(0.0f, layout.width - layout.paddingLeft - layout.paddingRight);
+    float contentHeight = std::max(0.0f, layout.height - layout.paddingTop - layout.paddingBottom);
+    
+    std::span<const GridTrack> columnTracks = style.gridColumns.tracks();
+    std::span<const GridTrack> rowTracks = style.gridRows.tracks();
+    size_t columnCount = std::max<size_t>(columnTracks.size(), 1);
+    
+    // Place the items to find the row count; rows past gridRows are auto
+    size_t rowCount = rowTracks.size();
+    size_t flowCount = 0;
+    GridPlacement placement(columnCount);
+    access.forEachFlowChild([&](auto child) {
+        GridCell cell = placement.place(access.style(child));
+        rowCount = std::max(rowCount, cell.row + cell.rowSpan);
+        ++flowCount;
+    });
+    
+    if (flowCount == 0) return;
+    
+    size_t trackCapacity = gridTrackStack.capacity();
+    GridTrackFrame tracks(columnCount, rowCount);
+    if (gridTrackStack.capacity() != trackCapacity) {
+        access.countAllocation();
+    }
+    
+    // Natural width of an item: its own, measured, or what its children need
+    auto naturalWidth = [&](auto child, const Style& childStyle) {
+        if (childStyle.width.isDefined()) {
+            return childStyle.width.resolve(contentWidth);
+        }
+        if (access.hasChildren(child)) {
+            LayoutResult& childLayout = access.layout(child);
+            childLayout.width = 0.0f;
+            childLayout.height = 0.0f;
+            access.layoutContainer(child, 0.0f, MeasureMode::AtMost,
+                                   contentHeight, MeasureMode::AtMost);
+            return childLayout.width;
+        }
+        if (access.hasMeasureFunc(child)) {
+            return access.measure(child, contentWidth, MeasureMode::AtMost,
+                                  contentHeight, MeasureMode::AtMost).width;
+        }
+        return 0.0f;
+    };
+    
+    // Natural height of an item at a width
+    auto naturalHeight = [&](auto child, const Style& childStyle, float width) {
+        if (childStyle.height.isDefined()) {
+            return childStyle.height.resolve(contentHeight);
+        }
+        if (access.hasChildren(child)) {
+            LayoutResult& childLayout = access.layout(child);
+            childLayout.width = width;
+            childLayout.height = 0.0f;
+            access.layoutContainer(child, width, MeasureMode::Exactly,
+                                   contentHeight, MeasureMode::AtMost);
+            return childLayout.height;
+        }
+        if (access.hasMeasureFunc(child)) {
+            return access.measure(child, width, MeasureMode::AtMost,
+                                  contentHeight, MeasureMode::AtMost).height;
+        }
+        return 0.0f;
+    };
+    
+    // Columns: auto tracks take their widest single-column item
+    placement = GridPlacement(columnCount);
+    access.forEachFlowChild([&](auto child) {
+        const auto& childStyle = access.style(child);
+        GridCell cell = placement.place(childStyle);
+        if (cell.columnSpan != 1 ||
+            gridTrackAt(columnTracks, cell.column).type != GridTrackType::Auto) {
+            return;
+        }
+        float width = naturalWidth(child, childStyle);
+        float& size = tracks.columnSizes()[cell.column];
+        size = std::max(size, width);
+    });
+    
+    float columnsExtent = sizeGridTracks(columnTracks, columnCount, contentWidth, style.gap,
+                                         tracks.columnSizes(), tracks.columnOffsets());
+    if (contentWidth <= 0 && columnsExtent > 0) {
+        contentWidth = columnsExtent;
+        layout.width = columnsExtent + layout.paddingLeft + layout.paddingRight;
+    }
+    
+    // Rows: auto tracks take their tallest single-row item, at its column width
+    placement = GridPlacement(columnCount);
+    access.forEachFlowChild([&](auto child) {
+        const auto& childStyle = access.style(child);
+        GridCell cell = placement.place(childStyle);
+        if (cell.rowSpan != 1 ||
+            gridTrackAt(rowTracks, cell.row).type != GridTrackType::Auto) {
+            return;
+        }
+        float cellWidth = gridSpanExtent(tracks.columnSizes(), tracks.columnOffsets(),
+                                         cell.column, cell.columnSpan);
+        float width = childStyle.width.isDefined() ? childStyle.width.resolve(contentWidth) : cellWidth;
+        float height = naturalHeight(child, childStyle, width);
+        float& size = tracks.rowSizes()[cell.row];
+        size = std::max(size, height);
+    });
+    
+    float rowsExtent = sizeGridTracks(rowTracks, rowCount, contentHeight, style.gap,
+                                      tracks.rowSizes(), tracks.rowOffsets());
+    if (!style.height.isDefined() && rowsExtent > 0) {
+        layout.height = rowsExtent + layout.paddingTop + layout.paddingBottom;
+    }
+    
+    // Position each item in its cell. Items without a size of their own
+    // fill the cell when stretched; otherwise alignItems/alignSelf places
+    // them on both axes.
+    placement = GridPlacement(columnCount);
+    access.forEachFlowChild([&](auto child) {
+        const auto& childStyle = access.style(child);
+        GridCell cell = placement.place(childStyle);
+        
+        float cellLeft = layout.paddingLeft + tracks.columnOffsets()[cell.column];
+        float cellTop = layout.paddingTop + tracks.rowOffsets()[cell.row];
+        float cellWidth = gridSpanExtent(tracks.columnSizes(), tracks.columnOffsets(),
+                                         cell.column, cell.columnSpan);
+        float cellHeight = gridSpanExtent(tracks.rowSizes(), tracks.rowOffsets(),
+                                          cell.row, cell.rowSpan);
+        
+        AlignItems align = resolveAlignment(style.alignItems, childStyle.alignSelf);
+        float width = cellWidth;
+        float height = cellHeight;
+        if (align != AlignItems::Stretch && access.hasMeasureFunc(child) &&
+            !access.hasChildren(child)) {
+            Size measured = access.measure(child, cellWidth, MeasureMode::AtMost,
+                                           cellHeight, MeasureMode::AtMost);
+            width = measured.width;
+            height = measured.height;
+        }
+        if (childStyle.width.isDefined()) {
+            width = childStyle.width.resolve(contentWidth);
+        }
+        if (childStyle.height.isDefined()) {
+            height = childStyle.height.resolve(contentHeight);
+        }
+        
+        float left = cellLeft;
+        float top = cellTop;
+        if (align == AlignItems::FlexEnd) {
+            left += cellWidth - width;
+            top += cellHeight - height;
+        } else if (align == AlignItems::Center) {
+            left += (cellWidth - width) / 2.0f;
+            top += (cellHeight - height) / 2.0f;
+        }
+        
+        LayoutResult& childLayout = access.layout(child);
+        childLayout.left = left;
+        childLayout.top = top;
+        childLayout.width = width;
+        childLayout.height = height;
+        
+        if (access.hasChildren(child)) {
+            access.layoutContainer(child,
+                                   width > 0 ? width : cellWidth,
+                                   width > 0 ? MeasureMode::Exactly : MeasureMode::AtMost,
+                                   height > 0 ? height : cellHeight,
+                                   height > 0 ? MeasureMode::Exactly : MeasureMode::AtMost);
+        } else {
+            access.finishLeaf(child);
+        }
+    });
+}
+
+/**
+ * A flex container in the middle of being laid out
+ * 
+ * Holds the state of one container between measuring its children and
+ * positioning them. Nested containers are laid out from an explicit
+ * stack of frames rather than by recursion, so how deep a tree can be
+ * is bounded by memory instead of the thread's stack.
+ */
+struct LayoutEngine::FlexFrame {
+    LayoutNode* node = nullptr;
+    size_t depth = 0;  // Below the node the pass started from
+    
+    // Containers entered through layoutChildContainer cache their
+    // result under these constraints once laid out
+    bool cacheResult = false;
+    LayoutConstraints constraints;
+    size_t misses = 0;
+    
+    bool isColumn = true;
+    bool isReverse = false;
+    float mainAxisSize = 0.0f;
+    float crossAxisSize = 0.0f;
+    size_t flowCount = 0;
+    float flexGrowUnit = 0.0f;
+    float interItemSpace = 0.0f;
+    float mainOffset = 0.0f;
+    
+    // Progress of pass 2
+    size_t next = 0;
+    size_t flowIndex = 0;
+    
+    // Nested container being laid out above this frame
+    LayoutNode* pending = nullptr;
+    LayoutConstraints pendingConstraints;
+    float pendingMainSize = 0.0f;
+    
+    // Nested containers handed to the thread pool; joined at the end
+    LayoutThreadPool* pool = nullptr;
+    std::unique_ptr<LayoutThreadPool::TaskGroup> subtreeTasks;
+};
+
+/**
+ * End of a LayoutJob slice. The clock is read every few containers only.
+ */
+struct LayoutEngine::Deadline {
+    static constexpr size_t kStepsPerCheck = 16;
+    
+    std::chrono::steady_clock::time_point time;
+    mutable size_t steps = 0;
+    
+    bool reached() const {
+        return ++steps % kStepsPerCheck == 0 && std::chrono::steady_clock::now() >= time;
+    }
+};
+
+std::vector<LayoutEngine::FlexFrame>& LayoutEngine::flexStack() {
+    // Per thread. Each layoutContainers call works above the frames that
+    // are already there, so calls nested in a pass (grid items, pool tasks
+    // run while waiting) share it. Frames may move when it grows; they
+    // are addressed by index across pushes.
+    static thread_local std::vector<FlexFrame> stack;
+    return stack;
+}
+
+void LayoutEngine::layoutFlexContainer(LayoutNode* node,
+                                        float availableWidth, MeasureMode widthMode,
+                                        float availableHeight, MeasureMode heightMode,
+                                        LayoutPass& pass) {
+    LayoutConstraints constraints{availableWidth, widthMode, availableHeight, heightMode};
+    layoutContainers(node, constraints, false, pass, 0);
+}
+
+void LayoutEngine::layoutContainers(LayoutNode* root, const LayoutConstraints& constraints,
+                                     bool cacheResult, LayoutPass& pass, size_t depth) {
+    std::vector<FlexFrame>& stack = flexStack();
+    size_t base = stack.size();
+    
+    beginContainer(stack, root, constraints, cacheResult, pass, depth);
+    runContainers(stack, base, pass, nullptr);
+}
+
+bool LayoutEngine::runContainers(std::vector<FlexFrame>& stack, size_t base, LayoutPass& pass,
+                                  const Deadline* deadline) {
+    while (stack.size() > base) {
+        if (deadline && deadline->reached()) {
+            return false;
+        }
+        
+        size_t top = stack.size() - 1;
+        if (LayoutNode* child = positionFlexChildren(stack[top], pass)) {
+            LayoutConstraints childConstraints = stack[top].pendingConstraints;
+            beginContainer(stack, child, childConstraints, true, pass, stack[top].depth + 1);
+            continue;
+        }
+        
+        if (stack[top].subtreeTasks) {
+            // Waiting runs queued tasks on this thread too, which push
+            // their own frames; only index the stack after it
+            LayoutThreadPool::TaskGroup& tasks = *stack[top].subtreeTasks;
+            stack[top].pool->wait(tasks);
+        }
+        
+        FlexFrame& frame = stack[top];
+        endFlexContainer(frame);
+        finishContainer(frame.node, frame.cacheResult, frame.constraints, frame.misses, pass);
+        stack.pop_back();
+    }
+    return true;
+}
+
+void LayoutEngine::beginContainer(std::vector<FlexFrame>& stack, LayoutNode* node,
+                                   const LayoutConstraints& constraints, bool cacheResult,
+                                   LayoutPass& pass, size_t depth) {
+    size_t misses = pass.missCount;
+    countVisit(node, pass);
+    pass.reachDepth(depth + 1);  // Its children
+    
+    // Dirty until its result is stored: a pass interrupted here lays it
+    // out again, and dirtiness from below reaches the root
+    node->isDirty_ = true;
+    node->hasDirtyDescendant_ = false;
+    
+    if (node->style_->display == Display::Grid) {
+        layoutGridContainer(NodeGridAccess{node, pass, depth}, *node->style_, node->getMutableLayout());
+        finishContainer(node, cacheResult, constraints, misses, pass);
+        return;
+    }
+    
+    size_t capacity = stack.capacity();
+    FlexFrame& frame = stack.emplace_back();
+    pass.count(LayoutPass::Allocations, stack.capacity() != capacity ? 1 : 0);
+    frame.node = node;
+    frame.depth = depth;
+    frame.cacheResult = cacheResult;
+    frame.constraints = constraints;
+    frame.misses = misses;
+    
+    if (!measureFlexChildren(frame, pass)) {
+        finishContainer(node, cacheResult, constraints, misses, pass);
+        stack.pop_back();
+    }
+}
+
+void LayoutEngine::finishContainer(LayoutNode* node, bool cacheResult,
+                                    const LayoutConstraints& constraints, size_t misses,
+                                    LayoutPass& pass) {
+    if (!cacheResult) return;
+    
+    if (pass.missCount != misses) {
+        // Laid out with provisional measurements; redo it next round
+        node->cache_.hasLayout = false;
+        return;
+    }
+    storeCachedLayout(node, constraints);
+}
+
+bool LayoutEngine::measureFlexChildren(FlexFrame& frame, LayoutPass& pass) {
+    LayoutNode* node = frame.node;
+    const Style& style = *node->style_;
+    LayoutResult& layout = node->getMutableLayout();
+    
+    bool isColumn = (style.flexDirection == FlexDirection::Column ||
+                     style.flexDirection == FlexDirection::ColumnReverse);
+    bool isReverse = (style.flexDirection == FlexDirection::ColumnReverse ||
+                      style.flexDirection == FlexDirection::RowReverse);
+    
+    float contentWidth = std::max(0.0f, layout.width - layout.paddingLeft - layout.paddingRight);
+    float contentHeight = std::max(0.0f, layout.height - layout.paddingTop - layout.paddingBottom);
+    
+    float mainAxisSize = isColumn ? contentHeight : contentWidth;
+    float crossAxisSize = isColumn ? contentWidth : contentHeight;
+    
+    bool crossAxisFromChildren = (crossAxisSize <= 0);
+    
+    const std::vector<LayoutNode*>& children = node->getChildren();
+    
+    float totalFlexGrow = 0.0f;
+    float totalFixedSize = 0.0f;
+    float maxChildCrossSize = 0.0f;
+    size_t flowCount = 0;
+    
+    // Pass 1: measure children in normal flow. Each child's base size is
+    // parked in its own layout result until pass 2 positions it, so the
+    // pass needs no scratch storage.
+    for (auto* child : children) {
+        const Style& childStyle = *child->style_;
+        if (childStyle.positionType != PositionType::Relative) {
+            continue;
+        }
+        ++flowCount;
+        
+        // Get child's base size on main axis
+        float childMainSize = 0.0f;
+        float childCrossSize = 0.0f;
+        
+        if (isColumn) {
+            // Main axis is height, cross axis is width
+            if (childStyle.height.isDefined()) {
+                childMainSize = childStyle.height.resolve(contentHeight);
+            }
+            if (childStyle.width.isDefined()) {
+                childCrossSize = childStyle.width.resolve(contentWidth);
+            }
+        } else {
+            // Main axis is width, cross axis is height
+            if (childStyle.width.isDefined()) {
+                childMainSize = childStyle.width.resolve(contentWidth);
+            }
+            if (childStyle.height.isDefined()) {
+                childCrossSize = childStyle.height.resolve(contentHeight);
+            }
+        }
+        
+        // If child has measure function, measure it
+        if (child->hasMeasureFunc()) {
+            Size measured = measureLeaf(
+                child,
+                contentWidth, MeasureMode::AtMost,
+                contentHeight, MeasureMode::AtMost,
+                pass
+            );
+            if (childMainSize == 0.0f) {
+                childMainSize = isColumn ? measured.height : measured.width;
+            }
+            if (childCrossSize == 0.0f) {
+                childCrossSize = isColumn ? measured.width : measured.height;
+            }
+        }
+        
+        // Store measurements
+        LayoutResult& childLayout = child->getMutableLayout();
+        childLayout.width = isColumn ? childCrossSize : childMainSize;
+        childLayout.height = isColumn ? childMainSize : childCrossSize;
+        
+        if (childCrossSize > maxChildCrossSize) {
+            maxChildCrossSize = childCrossSize;
+        }
+        
+        // Accumulate for flex calculation
+        totalFlexGrow += childStyle.flexGrow;
+        totalFixedSize += childMainSize;
+    }
+    
+    if (flowCount == 0) return false;
+    
+    // Calculate total gap space
+    float totalGap = style.gap * (flowCount - 1);
+    
+    if (crossAxisFromChildren && maxChildCrossSize > 0) {
+        crossAxisSize = maxChildCrossSize;
+        
+        // Update layout dimensions
+        if (isColumn) {
+            layout.width = crossAxisSize + layout.paddingLeft + layout.paddingRight;
+        } else {
+            layout.height = crossAxisSize + layout.paddingTop + layout.paddingBottom;
+        }
+    }
+    
+    // Calculate remaining space on main axis
+    float remainingSpace = mainAxisSize - totalFixedSize - totalGap;
+    float flexGrowUnit = (totalFlexGrow > 0 && remainingSpace > 0) 
+                         ? remainingSpace / totalFlexGrow 
+                         : 0.0f;
+    
+    float mainOffset = isColumn ? layout.paddingTop : layout.paddingLeft;
+    
+    // Handle justifyContent start offset and inter-item spacing
+    float interItemSpace = 0.0f;
+    if (totalFlexGrow == 0) {
+        float leadingSpace = 0.0f;
+        resolveJustifySpacing(style.justifyContent, remainingSpace, flowCount,
+                              leadingSpace, interItemSpace);
+        mainOffset += leadingSpace;
+    }
+    
+    frame.isColumn = isColumn;
+    frame.isReverse = isReverse;
+    frame.mainAxisSize = mainAxisSize;
+    frame.crossAxisSize = crossAxisSize;
+    frame.flowCount = flowCount;
+    frame.flexGrowUnit = flexGrowUnit;
+    frame.interItemSpace = interItemSpace;
+    frame.mainOffset = mainOffset;
+    frame.pool = (children.size() > 1) ? pass.options.threadPool : nullptr;
+    return true;
+}
+
+LayoutNode* LayoutEngine::positionFlexChildren(FlexFrame& frame, LayoutPass& pass) {
+    const Style& style = *frame.node->style_;
+    const LayoutResult& layout = frame.node->getLayout();
+    const std::vector<LayoutNode*>& children = frame.node->getChildren();
+    bool isColumn = frame.isColumn;
+    
+    // Back from laying out a nested container
+    if (frame.pending) {
+        advanceFlexChild(frame, frame.pending, frame.pendingMainSize, true);
+        frame.pending = nullptr;
+    }
+    
+    // Pass 2: position children, in reverse order if needed
+    while (frame.next < children.size()) {
+        size_t n = frame.next++;
+        auto* child = children[frame.isReverse ? children.size() - 1 - n : n];
+        const Style& childStyle = *child->style_;
+        if (childStyle.positionType != PositionType::Relative) {
+            continue;
+        }
+        LayoutResult& childLayout = child->getMutableLayout();
+        
+        float childMainSize = isColumn ? childLayout.height : childLayout.width;
+        float childCrossSize = isColumn ? childLayout.width : childLayout.height;
+        
+        // Add flex grow space
+        if (childStyle.flexGrow > 0 && frame.flexGrowUnit > 0) {
+            childMainSize += childStyle.flexGrow * frame.flexGrowUnit;
+        }
+        
+        // Handle alignItems/alignSelf for cross axis
+        AlignItems align = resolveAlignment(style.alignItems, childStyle.alignSelf);
+        
+        // Determine final cross size
+        float finalCrossSize = childCrossSize;
+        if (align == AlignItems::Stretch && childCrossSize == 0) {
+            // Stretch to fill container cross axis
+            finalCrossSize = frame.crossAxisSize;
+        } else if (finalCrossSize == 0) {
+            // If no explicit size, use natural size or stretch
+            finalCrossSize = frame.crossAxisSize;
+        }
+        
+        // Calculate cross axis offset
+        float crossOffset = isColumn ? layout.paddingLeft : layout.paddingTop;
+        switch (align) {
+            case AlignItems::FlexEnd:
+                crossOffset += frame.crossAxisSize - finalCrossSize;
+                break;
+            case AlignItems::Center:
+                crossOffset += (frame.crossAxisSize - finalCrossSize) / 2.0f;
+                break;
+            default:
+                break;
+        }
+        
+        // Set child position and size
+        if (isColumn) {
+            childLayout.left = crossOffset;
+            childLayout.top = frame.mainOffset;
+            childLayout.width = finalCrossSize;
+            childLayout.height = childMainSize;
+        } else {
+            childLayout.left = frame.mainOffset;
+            childLayout.top = crossOffset;
+            childLayout.width = childMainSize;
+            childLayout.height = finalCrossSize;
+        }
+        
+        if (child->getChildCount() == 0) {
+            // Leaves are sized by this loop directly
+            child->isDirty_ = false;
+            countVisit(child, pass);
+            advanceFlexChild(frame, child, childMainSize, false);
+            continue;
+        }
+        
+        float childContentWidth = childLayout.width;
+        float childContentHeight = childLayout.height;
+        
+        MeasureMode childWidthMode = (childContentWidth > 0) ? MeasureMode::Exactly : MeasureMode::AtMost;
+        MeasureMode childHeightMode = (childContentHeight > 0) ? MeasureMode::Exactly : MeasureMode::AtMost;
+        
+        float childAvailableWidth = (childContentWidth > 0) ? childContentWidth : frame.crossAxisSize;
+        float childAvailableHeight = (childContentHeight > 0) ? childContentHeight : frame.mainAxisSize;
+        
+        LayoutConstraints childConstraints{childAvailableWidth, childWidthMode,
+                                           childAvailableHeight, childHeightMode};
+        if (canReuseLayout(child, childConstraints)) {
+            restoreCachedLayout(child);
+            countSkip(child, pass);
+            advanceFlexChild(frame, child, childMainSize, true);
+            continue;
+        }
+        
+        const LayoutOptions& options = pass.options;
+        if (frame.pool && hasFixedMainSize(child, isColumn) &&
+            countNodes(child, options.parallelThreshold) >= options.parallelThreshold) {
+            // Later siblings don't depend on this subtree; lay it out on the pool
+            if (!frame.subtreeTasks) {
+                frame.subtreeTasks = std::make_unique<LayoutThreadPool::TaskGroup>();
+                pass.count(LayoutPass::Allocations);
+            }
+            size_t depth = frame.depth + 1;
+            frame.pool->run(*frame.subtreeTasks, [child, childConstraints, depth, &pass] {
+                layoutChildContainer(child, childConstraints.width, childConstraints.widthMode,
+                                     childConstraints.height, childConstraints.heightMode,
+                                     pass, depth);
+            });
+            advanceFlexChild(frame, child, childMainSize, false);
+            continue;
+        }
+        
+        // Lay it out next, from a frame above this one
+        frame.pending = child;
+        frame.pendingConstraints = childConstraints;
+        frame.pendingMainSize = childMainSize;
+        return child;
+    }
+    return nullptr;
+}
+
+void LayoutEngine::advanceFlexChild(FlexFrame& frame, LayoutNode* child, float childMainSize,
+                                     bool laidOut) {
+    if (laidOut) {
+        // A nested container may have grown along the main axis
+        float actualChildMainSize = frame.isColumn ? child->getLayout().height
+                                                   : child->getLayout().width;
+        if (actualChildMainSize != childMainSize) {
+            frame.mainOffset += (actualChildMainSize - childMainSize);
+            childMainSize = actualChildMainSize;
+        }
+    }
     
-    // Start layout from root with given constraints
-    layoutNode(root, availableWidth, MeasureMode::Exactly,
-               availableHeight, MeasureMode::Exactly);
+    // Advance main offset
+    frame.mainOffset += childMainSize + frame.node->style_->gap;
+    
+    // Add justify spacing
+    if (++frame.flowIndex < frame.flowCount) {
+        frame.mainOffset += frame.interItemSpace;
+    }
 }
 
-void LayoutEngine::layoutNode(LayoutNode* node,
-                               float availableWidth, MeasureMode widthMode,
-                               float availableHeight, MeasureMode heightMode) {
-    if (!node) return;
+void LayoutEngine::endFlexContainer(FlexFrame& frame) {
+    const Style& style = *frame.node->style_;
+    LayoutResult& layout = frame.node->getMutableLayout();
+    bool isColumn = frame.isColumn;
+    float requiredMainSize = frame.mainOffset - (isColumn ? layout.paddingTop : layout.paddingLeft);
     
-    const Style& style = node->getStyle();
-    LayoutResult& layout = node->getMutableLayout();
+    bool mainAxisNotDefined = isColumn ? !style.height.isDefined() : !style.width.isDefined();
+    if (mainAxisNotDefined && requiredMainSize > 0) {
+        if (isColumn) {
+            layout.height = requiredMainSize + layout.paddingTop + layout.paddingBottom;
+        } else {
+            layout.width = requiredMainSize + layout.paddingLeft + layout.paddingRight;
+        }
+    }
+}
+
+void LayoutEngine::layoutAbsoluteChildren(LayoutNode* node, LayoutPass& pass) {
+    const LayoutResult& layout = node->getLayout();
     
-    // 1. Resolve width
-    float resolvedWidth = 0.0f;
-    if (style.width.isDefined()) {
-        resolvedWidth = style.width.resolve(availableWidth);
-    } else if (widthMode == MeasureMode::Exactly) {
-        resolvedWidth = availableWidth;
-    } else if (widthMode == MeasureMode::AtMost) {
-        resolvedWidth = availableWidth;  // Start with max, may shrink
+    for (auto* child : node->getChildren()) {
+        if (child->style_->positionType != PositionType::Absolute) {
+            continue;
+        }
+        
+        LayoutResult& childLayout = child->getMutableLayout();
+        resolveAbsoluteFrame(*child->style_, layout, childLayout);
+        
+        // Recursively layout absolute child's children
+        if (child->getChildCount() > 0) {
+            layoutChildContainer(child, childLayout.width, MeasureMode::Exactly,
+                                 childLayout.height, MeasureMode::Exactly, pass, 1);
+        } else {
+            child->isDirty_ = false;
+            countVisit(child, pass);
+            pass.reachDepth(1);
+        }
     }
+}
+
+/**
+ * Saved state of a LayoutJob between slices
+ */
+struct LayoutJob::State {
+    enum class Phase {
+        Begin,          // Next round starts at the root
+        Containers,     // Frames left on the stack
+        Measure,        // Round done; batched measurements pending
+        Complete,
+        Cancelled
+    };
     
-    // Apply min/max constraints
-    if (style.minWidth.isDefined()) {
-        resolvedWidth = std::max(resolvedWidth, style.minWidth.resolve(availableWidth));
+    LayoutNode* root = nullptr;
+    LayoutConstraints constraints;
+    LayoutOptions options;
+    std::unique_ptr<LayoutPass> pass;
+    std::vector<LayoutEngine::FlexFrame> stack;
+    Phase phase = Phase::Begin;
+    size_t misses = 0;              // Of the pass when the root was begun
+    
+    // Root generation after the last slice, to notice changes in between
+    uint32_t generation = 0;
+    std::chrono::steady_clock::time_point start;
+    size_t slices = 0;
+    size_t restarts = 0;
+    
+    LayoutNode* treeRoot() const {
+        LayoutNode* node = root;
+        while (node->getParent()) node = node->getParent();
+        return node;
+    }
+};
+
+LayoutJob::LayoutJob(LayoutNode* root, float availableWidth, float availableHeight,
+                     const LayoutOptions& options)
+    : state_(std::make_unique<State>()) {
+    State& job = *state_;
+    job.root = root;
+    job.constraints = {availableWidth, MeasureMode::Exactly, availableHeight, MeasureMode::Exactly};
+    job.options = options;
+    job.pass = std::make_unique<LayoutPass>(job.options);
+    job.phase = root ? State::Phase::Begin : State::Phase::Complete;
+}
+
+LayoutJob::~LayoutJob() {
+    cancel();
+}
+
+bool LayoutJob::runSlice(std::chrono::microseconds budget) {
+    return LayoutEngine::runJob(*state_, budget);
+}
+
+void LayoutJob::cancel() {
+    State& job = *state_;
+    if (job.phase == State::Phase::Complete || job.phase == State::Phase::Cancelled) return;
+    
+    job.stack.clear();
+    job.phase = State::Phase::Cancelled;
+    if (job.slices > 0 && job.root->getParent()) {
+        // Its parent must lay the partly laid out subtree out again
+        job.root->markDirty(DirtyReason::Relayout);
+    }
+}
+
+bool LayoutJob::isComplete() const {
+    return state_->phase == State::Phase::Complete;
+}
+
+bool LayoutJob::isCancelled() const {
+    return state_->phase == State::Phase::Cancelled;
+}
+
+LayoutNode* LayoutJob::getRoot() const {
+    return state_->root;
+}
+
+size_t LayoutJob::getSliceCount() const {
+    return state_->slices;
+}
+
+size_t LayoutJob::getRestartCount() const {
+    return state_->restarts;
+}
+
+bool LayoutEngine::runJob(LayoutJob::State& job, std::chrono::microseconds budget) {
+    using Phase = LayoutJob::State::Phase;
+    if (job.phase == Phase::Complete || job.phase == Phase::Cancelled) {
+        return job.phase == Phase::Complete;
     }
-    if (style.maxWidth.isDefined()) {
-        resolvedWidth = std::min(resolvedWidth, style.maxWidth.resolve(availableWidth));
+    
+    auto now = std::chrono::steady_clock::now();
+    if (job.slices++ == 0) {
+        job.start = now;
+    } else if (job.treeRoot()->dirtyGeneration_ != job.generation) {
+        // Marked dirty since the last slice; frames may hold removed nodes,
+        // so drop them unread. Nodes they were laying out are still dirty.
+        job.stack.clear();
+        job.pass = std::make_unique<LayoutPass>(job.options);
+        job.phase = Phase::Begin;
+        ++job.restarts;
     }
     
-    // 2. Resolve height
-    float resolvedHeight = 0.0f;
-    if (style.height.isDefined()) {
-        resolvedHeight = style.height.resolve(availableHeight);
-    } else if (heightMode == MeasureMode::Exactly) {
-        resolvedHeight = availableHeight;
-    } else if (heightMode == MeasureMode::AtMost) {
-        resolvedHeight = availableHeight;  // Start with max, may shrink
+    Deadline deadline{now + budget};
+    bool complete = runJobRounds(job, deadline);
+    if (!complete) {
+        job.generation = job.treeRoot()->dirtyGeneration_;
     }
+    return complete;
+}
+
+bool LayoutEngine::runJobRounds(LayoutJob::State& job, const Deadline& deadline) {
+    using Phase = LayoutJob::State::Phase;
     
-    // Apply min/max constraints
-    if (style.minHeight.isDefined()) {
-        resolvedHeight = std::max(resolvedHeight, style.minHeight.resolve(availableHeight));
+    // The rounds of calculateLayout, with the root's flex container run
+    // from the job's own stack
+    while (true) {
+        LayoutPass& pass = *job.pass;
+        switch (job.phase) {
+            case Phase::Begin:
+                if (reuseRootLayout(job.root, job.constraints, pass)) {
+                    job.phase = Phase::Measure;
+                    break;
+                }
+                job.misses = pass.missCount;
+                beginNode(job.root, job.constraints, pass);
+                if (job.root->getChildCount() > 0) {
+                    const LayoutResult& layout = job.root->getLayout();
+                    LayoutConstraints content{layout.width, MeasureMode::Exactly,
+                                              layout.height, MeasureMode::Exactly};
+                    beginContainer(job.stack, job.root, content, false, pass, 0);
+                }
+                job.phase = Phase::Containers;
+                break;
+                
+            case Phase::Containers:
+                if (!runContainers(job.stack, 0, pass, &deadline)) {
+                    // Pool tasks finish before the tree is handed back
+                    for (FlexFrame& frame : job.stack) {
+                        if (frame.subtreeTasks) frame.pool->wait(*frame.subtreeTasks);
+                    }
+                    return false;
+                }
+                finishNode(job.root, job.constraints, job.misses, pass);
+                job.phase = Phase::Measure;
+                break;
+                
+            case Phase::Measure:
+                if (measurePending(pass)) {
+                    job.phase = Phase::Begin;
+                    if (std::chrono::steady_clock::now() >= deadline.time) return false;
+                    break;
+                }
+                if (job.options.stats) pass.report(*job.options.stats, job.start);
+                job.phase = Phase::Complete;
+                return true;
+                
+            case Phase::Complete:
+                return true;
+                
+            case Phase::Cancelled:
+                return false;
+        }
     }
-    if (style.maxHeight.isDefined()) {
-        resolvedHeight = std::min(resolvedHeight, style.maxHeight.resolve(availableHeight));
+}
+
+void LayoutEngine::applyLayout(LayoutNode* root, SetFrameFunc setFrameFunc) {
+    if (!root || !setFrameFunc) return;
+    
+    // Frames are relative to the parent, so the order views are visited
+    // in doesn't matter; walk the tree without a stack
+    for (LayoutNode* node = root; node; node = node->nextInPreOrder(root)) {
+        if (node->getNativeView()) {
+            const LayoutResult& layout = node->getLayout();
+            setFrameFunc(node->getNativeView(), layout.left, layout.top,
+                        layout.width, layout.height);
+            
+            // Keeps later change-detected applies in sync
+            node->appliedFrame_ = {node->getNativeView(), layout.left, layout.top,
+                                   layout.width, layout.height};
+        }
     }
+}
+
+size_t LayoutEngine::applyLayout(LayoutNode* root, FrameBuffer& frames, ApplyFramesFunc applyFrames) {
+    if (!root || !applyFrames) return 0;
+    
+    frames.collectChanges(root);
+    return frames.apply(applyFrames);
+}
+
+// Flat LayoutTree implementation
+//
+// Mirrors the LayoutNode algorithm above. Children are walked through the
+// sibling index arrays, and each flow child's base size is parked in its
+// own result slot between the measure and position passes, so no
+// per-container scratch storage is needed.
+
+void LayoutEngine::calculateLayout(LayoutTree& tree, NodeId root,
+                                    float availableWidth,
+                                    float availableHeight) {
+    if (root >= tree.size()) return;
+    
+    layoutTreeNode(tree, root, availableWidth, MeasureMode::Exactly,
+                   availableHeight, MeasureMode::Exactly);
+}
+
+void LayoutEngine::layoutTreeNode(LayoutTree& tree, NodeId node,
+                                   float availableWidth, MeasureMode widthMode,
+                                   float availableHeight, MeasureMode heightMode) {
+    const Style& style = tree.getStyle(node);
+    LayoutResult& layout = tree.getMutableLayout(node);
+    
+    float resolvedWidth = resolveDimension(style.width, style.minWidth, style.maxWidth,
+                                           availableWidth, widthMode);
+    float resolvedHeight = resolveDimension(style.height, style.minHeight, style.maxHeight,
+                                            availableHeight, heightMode);
     
-    // Store dimensions
     layout.width = resolvedWidth;
     layout.height = resolvedHeight;
     
-    // 3. Resolve padding
     getPadding(style, resolvedWidth, resolvedHeight,
                layout.paddingLeft, layout.paddingTop,
                layout.paddingRight, layout.paddingBottom);
     
-    // 4. Layout children if this is a container
-    if (node->getChildCount() > 0) {
-        layoutFlexContainer(node, resolvedWidth, MeasureMode::Exactly,
-                           resolvedHeight, MeasureMode::Exactly);
-    } else if (node->hasMeasureFunc()) {
-        // Leaf node with measure function - measure it
-        Size measured = node->measure(resolvedWidth, widthMode,
-                                       resolvedHeight, heightMode);
+    if (tree.getChildCount(node) > 0) {
+        layoutTreeFlexContainer(tree, node);
+    } else if (tree.hasMeasureFunc(node)) {
+        Size measured = tree.measure(node, resolvedWidth, widthMode,
+                                     resolvedHeight, heightMode);
         layout.width = measured.width;
         layout.height = measured.height;
     }
     
-    // 5. Layout absolute positioned children
-    layoutAbsoluteChildren(node);
+    layoutTreeAbsoluteChildren(tree, node);
 }
 
-void LayoutEngine::layoutFlexContainer(LayoutNode* node,
-                                        float /* availableWidth */, MeasureMode /* widthMode */,
-                                        float /* availableHeight */, MeasureMode /* heightMode */) {
-    const Style& style = node->getStyle();
-    LayoutResult& layout = node->getMutableLayout();
+/**
+ * A flat-tree flex container in the middle of being laid out
+ * 
+ * Counterpart of FlexFrame: nested containers are laid out from an
+ * explicit stack instead of recursively.
+ */
+struct LayoutEngine::TreeFlexFrame {
+    NodeId node = kInvalidNodeId;
+    
+    bool isColumn = true;
+    bool isReverse = false;
+    float mainAxisSize = 0.0f;
+    float crossAxisSize = 0.0f;
+    size_t flowCount = 0;
+    float flexGrowUnit = 0.0f;
+    float interItemSpace = 0.0f;
+    float mainOffset = 0.0f;
+    
+    // Container style pass 2 needs, decoded once in pass 1
+    float gap = 0.0f;
+    AlignItems alignItems = AlignItems::Stretch;
+    bool mainSizeDefined = false;
+    
+    // Progress of pass 2
+    NodeId next = kInvalidNodeId;
+    size_t flowIndex = 0;
+    
+    // Nested container being laid out above this frame
+    NodeId pending = kInvalidNodeId;
+    float pendingMainSize = 0.0f;
+};
+
+std::vector<LayoutEngine::TreeFlexFrame>& LayoutEngine::treeFlexStack() {
+    static thread_local std::vector<TreeFlexFrame> stack;
+    return stack;
+}
+
+void LayoutEngine::layoutTreeFlexContainer(LayoutTree& tree, NodeId root) {
+    std::vector<TreeFlexFrame>& stack = treeFlexStack();
+    size_t base = stack.size();
+    
+    beginTreeContainer(tree, stack, root);
+    while (stack.size() > base) {
+        NodeId child = positionTreeFlexChildren(tree, stack.back());
+        if (child != kInvalidNodeId) {
+            beginTreeContainer(tree, stack, child);
+            continue;
+        }
+        endTreeFlexContainer(tree, stack.back());
+        stack.pop_back();
+    }
+}
+
+void LayoutEngine::beginTreeContainer(LayoutTree& tree, std::vector<TreeFlexFrame>& stack,
+                                       NodeId node) {
+    // Decoded once per container; children are read from their compact styles
+    Style style = tree.getStyle(node);
+    if (style.display == Display::Grid) {
+        layoutGridContainer(TreeGridAccess{tree, node}, style, tree.getMutableLayout(node));
+        return;
+    }
+    
+    TreeFlexFrame& frame = stack.emplace_back();
+    frame.node = node;
+    if (!measureTreeFlexChildren(tree, frame, style)) {
+        stack.pop_back();
+    }
+}
+
+bool LayoutEngine::measureTreeFlexChildren(LayoutTree& tree, TreeFlexFrame& frame,
+                                            const Style& style) {
+    NodeId node = frame.node;
+    LayoutResult& layout = tree.getMutableLayout(node);
     
     bool isColumn = (style.flexDirection == FlexDirection::Column ||
                      style.flexDirection == FlexDirection::ColumnReverse);
@@ -118,62 +1731,37 @@ void LayoutEngine::layoutFlexContainer(LayoutNode* node,
     
     bool crossAxisFromChildren = (crossAxisSize <= 0);
     
-    // Collect children that are in normal flow
-    std::vector<LayoutNode*> flowChildren;
-    for (auto* child : node->getChildren()) {
-        if (child->getStyle().positionType == PositionType::Relative) {
-            flowChildren.push_back(child);
-        }
-    }
-    
-    if (flowChildren.empty()) return;
-    
-    // Calculate total gap space
-    float totalGap = style.gap * (flowChildren.size() - 1);
-    
+    size_t flowCount = 0;
     float totalFlexGrow = 0.0f;
     float totalFixedSize = 0.0f;
     float maxChildCrossSize = 0.0f;
     
-    // Store measured sizes for second pass
-    struct ChildMeasurement {
-        float mainSize;
-        float crossSize;
-    };
-    std::vector<ChildMeasurement> childMeasurements(flowChildren.size());
-    
-    for (size_t i = 0; i < flowChildren.size(); ++i) {
-        auto* child = flowChildren[i];
-        const Style& childStyle = child->getStyle();
+    // Pass 1: base sizes of children in normal flow
+    for (NodeId child = tree.getFirstChild(node); child != kInvalidNodeId;
+         child = tree.getNextSibling(child)) {
+        const CompactStyle& childStyle = tree.getCompactStyle(child);
+        if (childStyle.getPositionType() != PositionType::Relative) continue;
+        const float* childValues = tree.getStyleValues(child);
+        ++flowCount;
         
-        // Get child's base size on main axis
         float childMainSize = 0.0f;
         float childCrossSize = 0.0f;
         
-        if (isColumn) {
-            // Main axis is height, cross axis is width
-            if (childStyle.height.isDefined()) {
-                childMainSize = childStyle.height.resolve(contentHeight);
-            }
-            if (childStyle.width.isDefined()) {
-                childCrossSize = childStyle.width.resolve(contentWidth);
-            }
-        } else {
-            // Main axis is width, cross axis is height
-            if (childStyle.width.isDefined()) {
-                childMainSize = childStyle.width.resolve(contentWidth);
-            }
-            if (childStyle.height.isDefined()) {
-                childCrossSize = childStyle.height.resolve(contentHeight);
-            }
+        LayoutValue mainDimension = childStyle.getLayoutValue(
+            isColumn ? StyleProperty::Height : StyleProperty::Width, childValues);
+        LayoutValue crossDimension = childStyle.getLayoutValue(
+            isColumn ? StyleProperty::Width : StyleProperty::Height, childValues);
+        if (mainDimension.isDefined()) {
+            childMainSize = mainDimension.resolve(isColumn ? contentHeight : contentWidth);
+        }
+        if (crossDimension.isDefined()) {
+            childCrossSize = crossDimension.resolve(isColumn ? contentWidth : contentHeight);
         }
         
-        // If child has measure function, measure it
-        if (child->hasMeasureFunc()) {
-            Size measured = child->measure(
-                contentWidth, MeasureMode::AtMost,
-                contentHeight, MeasureMode::AtMost
-            );
+        if (tree.hasMeasureFunc(child)) {
+            Size measured = tree.measure(child,
+                                         contentWidth, MeasureMode::AtMost,
+                                         contentHeight, MeasureMode::AtMost);
             if (childMainSize == 0.0f) {
                 childMainSize = isColumn ? measured.height : measured.width;
             }
@@ -182,186 +1770,151 @@ void LayoutEngine::layoutFlexContainer(LayoutNode* node,
             }
         }
         
-        // Store measurements
-        childMeasurements[i].mainSize = childMainSize;
-        childMeasurements[i].crossSize = childCrossSize;
-        
-        if (childCrossSize > maxChildCrossSize) {
-            maxChildCrossSize = childCrossSize;
-        }
+        // Park base sizes in the child's result until pass 2
+        LayoutResult& childLayout = tree.getMutableLayout(child);
+        childLayout.width = isColumn ? childCrossSize : childMainSize;
+        childLayout.height = isColumn ? childMainSize : childCrossSize;
         
-        // Accumulate for flex calculation
-        totalFlexGrow += childStyle.flexGrow;
+        maxChildCrossSize = std::max(maxChildCrossSize, childCrossSize);
+        totalFlexGrow += childStyle.getFloat(StyleProperty::FlexGrow, childValues, 0.0f);
         totalFixedSize += childMainSize;
     }
     
+    if (flowCount == 0) return false;
+    
+    float totalGap = style.gap * (flowCount - 1);
+    
     if (crossAxisFromChildren && maxChildCrossSize > 0) {
         crossAxisSize = maxChildCrossSize;
-        
-        // Update layout dimensions
         if (isColumn) {
             layout.width = crossAxisSize + layout.paddingLeft + layout.paddingRight;
-            contentWidth = crossAxisSize;
         } else {
             layout.height = crossAxisSize + layout.paddingTop + layout.paddingBottom;
-            contentHeight = crossAxisSize;
         }
     }
     
-    // Calculate remaining space on main axis
     float remainingSpace = mainAxisSize - totalFixedSize - totalGap;
-    float flexGrowUnit = (totalFlexGrow > 0 && remainingSpace > 0) 
-                         ? remainingSpace / totalFlexGrow 
+    float flexGrowUnit = (totalFlexGrow > 0 && remainingSpace > 0)
+                         ? remainingSpace / totalFlexGrow
                          : 0.0f;
     
     float mainOffset = isColumn ? layout.paddingTop : layout.paddingLeft;
     
-    // Handle justifyContent start offset
-    if (totalFlexGrow == 0 && remainingSpace > 0) {
-        switch (style.justifyContent) {
-            case JustifyContent::FlexEnd:
-                mainOffset += remainingSpace;
-                break;
-            case JustifyContent::Center:
-                mainOffset += remainingSpace / 2.0f;
-                break;
-            case JustifyContent::SpaceBetween:
-                // No initial offset, space distributed between
-                break;
-            case JustifyContent::SpaceAround:
-                mainOffset += remainingSpace / (flowChildren.size() * 2);
-                break;
-            case JustifyContent::SpaceEvenly:
-                mainOffset += remainingSpace / (flowChildren.size() + 1);
-                break;
-            default:
-                break;
-        }
-    }
-    
-    // Calculate inter-item spacing for justify modes
     float interItemSpace = 0.0f;
-    if (totalFlexGrow == 0 && remainingSpace > 0 && flowChildren.size() > 1) {
-        switch (style.justifyContent) {
-            case JustifyContent::SpaceBetween:
-                interItemSpace = remainingSpace / (flowChildren.size() - 1);
-                break;
-            case JustifyContent::SpaceAround:
-                interItemSpace = remainingSpace / flowChildren.size();
-                break;
-            case JustifyContent::SpaceEvenly:
-                interItemSpace = remainingSpace / (flowChildren.size() + 1);
-                break;
-            default:
-                break;
-        }
+    if (totalFlexGrow == 0) {
+        float leadingSpace = 0.0f;
+        resolveJustifySpacing(style.justifyContent, remainingSpace, flowCount,
+                              leadingSpace, interItemSpace);
+        mainOffset += leadingSpace;
     }
     
-    // Reverse order if needed
-    if (isReverse) {
-        std::reverse(flowChildren.begin(), flowChildren.end());
-        std::reverse(childMeasurements.begin(), childMeasurements.end());
+    frame.isColumn = isColumn;
+    frame.isReverse = isReverse;
+    frame.mainAxisSize = mainAxisSize;
+    frame.crossAxisSize = crossAxisSize;
+    frame.flowCount = flowCount;
+    frame.flexGrowUnit = flexGrowUnit;
+    frame.interItemSpace = interItemSpace;
+    frame.mainOffset = mainOffset;
+    frame.gap = style.gap;
+    frame.alignItems = style.alignItems;
+    frame.mainSizeDefined = isColumn ? style.height.isDefined() : style.width.isDefined();
+    frame.next = isReverse ? tree.getLastChild(node) : tree.getFirstChild(node);
+    return true;
+}
+
+NodeId LayoutEngine::positionTreeFlexChildren(LayoutTree& tree, TreeFlexFrame& frame) {
+    const LayoutResult& layout = tree.getLayout(frame.node);
+    bool isColumn = frame.isColumn;
+    
+    // Back from laying out a nested container
+    if (frame.pending != kInvalidNodeId) {
+        advanceTreeFlexChild(tree, frame, frame.pending, frame.pendingMainSize, true);
+        frame.pending = kInvalidNodeId;
     }
     
-    for (size_t i = 0; i < flowChildren.size(); ++i) {
-        auto* child = flowChildren[i];
-        const Style& childStyle = child->getStyle();
-        LayoutResult& childLayout = child->getMutableLayout();
+    // Pass 2: position children, in reverse order if needed
+    while (frame.next != kInvalidNodeId) {
+        NodeId child = frame.next;
+        frame.next = frame.isReverse ? tree.getPrevSibling(child) : tree.getNextSibling(child);
+        const CompactStyle& childStyle = tree.getCompactStyle(child);
+        if (childStyle.getPositionType() != PositionType::Relative) continue;
         
-        float childMainSize = childMeasurements[i].mainSize;
-        float childCrossSize = childMeasurements[i].crossSize;
+        LayoutResult& childLayout = tree.getMutableLayout(child);
+        float childMainSize = isColumn ? childLayout.height : childLayout.width;
+        float childCrossSize = isColumn ? childLayout.width : childLayout.height;
         
-        // Add flex grow space
-        if (childStyle.flexGrow > 0 && flexGrowUnit > 0) {
-            childMainSize += childStyle.flexGrow * flexGrowUnit;
+        float flexGrow = childStyle.getFloat(StyleProperty::FlexGrow, tree.getStyleValues(child), 0.0f);
+        if (flexGrow > 0 && frame.flexGrowUnit > 0) {
+            childMainSize += flexGrow * frame.flexGrowUnit;
         }
         
-        // Handle alignItems/alignSelf for cross axis
-        AlignItems align = style.alignItems;
-        if (childStyle.alignSelf != AlignSelf::Auto) {
-            switch (childStyle.alignSelf) {
-                case AlignSelf::FlexStart: align = AlignItems::FlexStart; break;
-                case AlignSelf::FlexEnd: align = AlignItems::FlexEnd; break;
-                case AlignSelf::Center: align = AlignItems::Center; break;
-                case AlignSelf::Stretch: align = AlignItems::Stretch; break;
-                default: break;
-            }
-        }
+        AlignItems align = resolveAlignment(frame.alignItems, childStyle.getAlignSelf());
         
-        // Determine final cross size
         float finalCrossSize = childCrossSize;
-        if (align == AlignItems::Stretch && childCrossSize == 0) {
-            // Stretch to fill container cross axis
-            finalCrossSize = crossAxisSize;
-        } else if (finalCrossSize == 0) {
-            // If no explicit size, use natural size or stretch
-            finalCrossSize = crossAxisSize;
+        if (finalCrossSize == 0) {
+            finalCrossSize = frame.crossAxisSize;
         }
         
-        // Calculate cross axis offset
         float crossOffset = isColumn ? layout.paddingLeft : layout.paddingTop;
         switch (align) {
             case AlignItems::FlexEnd:
-                crossOffset += crossAxisSize - finalCrossSize;
+                crossOffset += frame.crossAxisSize - finalCrossSize;
                 break;
             case AlignItems::Center:
-                crossOffset += (crossAxisSize - finalCrossSize) / 2.0f;
+                crossOffset += (frame.crossAxisSize - finalCrossSize) / 2.0f;
                 break;
             default:
                 break;
         }
         
-        // Set child position and size
         if (isColumn) {
             childLayout.left = crossOffset;
-            childLayout.top = mainOffset;
+            childLayout.top = frame.mainOffset;
             childLayout.width = finalCrossSize;
             childLayout.height = childMainSize;
         } else {
-            childLayout.left = mainOffset;
+            childLayout.left = frame.mainOffset;
             childLayout.top = crossOffset;
             childLayout.width = childMainSize;
             childLayout.height = finalCrossSize;
         }
         
-        if (child->getChildCount() > 0) {
-            float childContentWidth = childLayout.width;
-            float childContentHeight = childLayout.height;
-            
-            MeasureMode childWidthMode = (childContentWidth > 0) ? MeasureMode::Exactly : MeasureMode::AtMost;
-            MeasureMode childHeightMode = (childContentHeight > 0) ? MeasureMode::Exactly : MeasureMode::AtMost;
-            
-            float childAvailableWidth = (childContentWidth > 0) ? childContentWidth : crossAxisSize;
-            float childAvailableHeight = (childContentHeight > 0) ? childContentHeight : mainAxisSize;
-            
-            layoutFlexContainer(child, childAvailableWidth, childWidthMode,
-                               childAvailableHeight, childHeightMode);
-            
-            float actualChildMainSize = isColumn ? childLayout.height : childLayout.width;
-            if (actualChildMainSize != childMainSize) {
-                if (isColumn) {
-                    childLayout.height = actualChildMainSize;
-                } else {
-                    childLayout.width = actualChildMainSize;
-                }
-                mainOffset += (actualChildMainSize - childMainSize);
-                childMainSize = actualChildMainSize;
-            }
+        if (tree.getChildCount(child) > 0) {
+            // Lay it out next, from a frame above this one
+            frame.pending = child;
+            frame.pendingMainSize = childMainSize;
+            return child;
         }
-        
-        // Advance main offset
-        mainOffset += childMainSize + style.gap;
-        
-        // Add justify spacing
-        if (i < flowChildren.size() - 1) {
-            mainOffset += interItemSpace;
+        advanceTreeFlexChild(tree, frame, child, childMainSize, false);
+    }
+    return kInvalidNodeId;
+}
+
+void LayoutEngine::advanceTreeFlexChild(LayoutTree& tree, TreeFlexFrame& frame, NodeId child,
+                                         float childMainSize, bool laidOut) {
+    if (laidOut) {
+        const LayoutResult& childLayout = tree.getLayout(child);
+        float actualChildMainSize = frame.isColumn ? childLayout.height : childLayout.width;
+        if (actualChildMainSize != childMainSize) {
+            frame.mainOffset += (actualChildMainSize - childMainSize);
+            childMainSize = actualChildMainSize;
         }
     }
     
-    float requiredMainSize = mainOffset - (isColumn ? layout.paddingTop : layout.paddingLeft);
+    frame.mainOffset += childMainSize + frame.gap;
     
-    bool mainAxisNotDefined = isColumn ? !style.height.isDefined() : !style.width.isDefined();
-    if (mainAxisNotDefined && requiredMainSize > 0) {
+    if (++frame.flowIndex < frame.flowCount) {
+        frame.mainOffset += frame.interItemSpace;
+    }
+}
+
+void LayoutEngine::endTreeFlexContainer(LayoutTree& tree, TreeFlexFrame& frame) {
+    LayoutResult& layout = tree.getMutableLayout(frame.node);
+    bool isColumn = frame.isColumn;
+    float requiredMainSize = frame.mainOffset - (isColumn ? layout.paddingTop : layout.paddingLeft);
+    
+    if (!frame.mainSizeDefined && requiredMainSize > 0) {
         if (isColumn) {
             layout.height = requiredMainSize + layout.paddingTop + layout.paddingBottom;
         } else {
@@ -370,76 +1923,62 @@ void LayoutEngine::layoutFlexContainer(LayoutNode* node,
     }
 }
 
-void LayoutEngine::layoutAbsoluteChildren(LayoutNode* node) {
-    const LayoutResult& layout = node->getLayout();
+void LayoutEngine::layoutTreeAbsoluteChildren(LayoutTree& tree, NodeId node) {
+    const LayoutResult& layout = tree.getLayout(node);
     
-    for (auto* child : node->getChildren()) {
-        if (child->getStyle().positionType != PositionType::Absolute) {
+    for (NodeId child = tree.getFirstChild(node); child != kInvalidNodeId;
+         child = tree.getNextSibling(child)) {
+        const CompactStyle& childStyle = tree.getCompactStyle(child);
+        if (childStyle.getPositionType() != PositionType::Absolute) {
             continue;
         }
         
-        const Style& childStyle = child->getStyle();
-        LayoutResult& childLayout = child->getMutableLayout();
-        
-        // Calculate size
-        float width = childStyle.width.resolve(layout.width);
-        float height = childStyle.height.resolve(layout.height);
-        
-        // Calculate position
-        float left = 0.0f;
-        float top = 0.0f;
-        
-        if (childStyle.position[0].isDefined()) {  // left
-            left = childStyle.position[0].resolve(layout.width);
-        } else if (childStyle.position[2].isDefined()) {  // right
-            left = layout.width - width - childStyle.position[2].resolve(layout.width);
-        }
-        
-        if (childStyle.position[1].isDefined()) {  // top
-            top = childStyle.position[1].resolve(layout.height);
-        } else if (childStyle.position[3].isDefined()) {  // bottom
-            top = layout.height - height - childStyle.position[3].resolve(layout.height);
-        }
-        
-        childLayout.left = left;
-        childLayout.top = top;
-        childLayout.width = width;
-        childLayout.height = height;
+        const float* childValues = tree.getStyleValues(child);
+        const LayoutValue position[4] = {
+            childStyle.getLayoutValue(StyleProperty::PositionLeft, childValues),
+            childStyle.getLayoutValue(StyleProperty::PositionTop, childValues),
+            childStyle.getLayoutValue(StyleProperty::PositionRight, childValues),
+            childStyle.getLayoutValue(StyleProperty::PositionBottom, childValues),
+        };
+        resolveAbsoluteFrame(childStyle.getLayoutValue(StyleProperty::Width, childValues),
+                             childStyle.getLayoutValue(StyleProperty::Height, childValues),
+                             position, layout, tree.getMutableLayout(child));
         
-        // Recursively layout absolute child's children
-        if (child->getChildCount() > 0) {
-            layoutFlexContainer(child, width, MeasureMode::Exactly,
-                               height, MeasureMode::Exactly);
+        if (tree.getChildCount(child) > 0) {
+            layoutTreeFlexContainer(tree, child);
         }
     }
 }
 
-void LayoutEngine::applyLayout(LayoutNode* root, SetFrameFunc setFrameFunc) {
-    if (!root || !setFrameFunc) return;
+void LayoutEngine::applyLayout(const LayoutTree& tree, NodeId root, SetFrameFunc setFrameFunc) {
+    if (root >= tree.size() || !setFrameFunc) return;
     
-    applyLayoutRecursive(root, setFrameFunc, 0.0f, 0.0f);
+    // Pre-order walk over the index links; no recursion or stack needed
+    NodeId node = root;
+    while (true) {
+        if (void* view = tree.getNativeView(node)) {
+            const LayoutResult& layout = tree.getLayout(node);
+            setFrameFunc(view, layout.left, layout.top, layout.width, layout.height);
+        }
+        
+        if (tree.getFirstChild(node) != kInvalidNodeId) {
+            node = tree.getFirstChild(node);
+            continue;
+        }
+        while (node != root && tree.getNextSibling(node) == kInvalidNodeId) {
+            node = tree.getParent(node);
+        }
+        if (node == root) break;
+        node = tree.getNextSibling(node);
+    }
 }
 
-void LayoutEngine::applyLayoutRecursive(LayoutNode* node,
-                                         SetFrameFunc setFrameFunc,
-                                         float parentAbsX,
-                                         float parentAbsY) {
-    const LayoutResult& layout = node->getLayout();
-    
-    // Calculate absolute position
-    float absX = parentAbsX + layout.left;
-    float absY = parentAbsY + layout.top;
+size_t LayoutEngine::applyLayout(const LayoutTree& tree, NodeId root, FrameBuffer& frames,
+                                  ApplyFramesFunc applyFrames) {
+    if (root >= tree.size() || !applyFrames) return 0;
     
-    // Apply to native view if present
-    if (node->getNativeView()) {
-        setFrameFunc(node->getNativeView(), layout.left, layout.top,
-                    layout.width, layout.height);
-    }
-    
-    // Recurse to children
-    for (auto* child : node->getChildren()) {
-        applyLayoutRecursive(child, setFrameFunc, absX, absY);
-    }
+    frames.collectChanges(tree, root);
+    return frames.apply(applyFrames);
 }
 
 } // namespace obsidian::layout
@@ -10,9 +10,129 @@
 #pragma once
 
 #include "node.h"
+#include "layout_tree.h"
+#include "frame_buffer.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
 
 namespace obsidian::layout {
 
+class LayoutThreadPool;
+struct LayoutPass;
+
+/**
+ * A leaf measurement requested during a batched layout pass
+ */
+struct MeasureRequest {
+    LayoutNode* node = nullptr;
+    LayoutConstraints constraints;
+    Size result;  // Filled in by the batch measurer
+};
+
+/**
+ * Measures a batch of leaves in one call, filling in each request's result.
+ * Implementations identify what to measure from the node, e.g. its native view.
+ */
+using BatchMeasureFunc = std::function<void(MeasureRequest* requests, size_t count)>;
+
+/**
+ * What a layout pass did
+ * Filled in by calculateLayout and layoutBoundary when LayoutOptions::stats
+ * is set. Cheap enough to leave on in production builds.
+ */
+struct LayoutStats {
+    size_t nodesVisited = 0;        // Nodes laid out
+    size_t nodesSkipped = 0;        // Clean subtrees restored from their cache, not visited
+    size_t measureCalls = 0;        // Leaves measured by a measure function or batch
+    size_t measureCacheHits = 0;
+    size_t measureCacheMisses = 0;
+    size_t maxDepth = 0;            // Deepest node reached, below the node laid out
+    size_t allocations = 0;         // Growths of the engine's scratch buffers
+    double wallTimeMs = 0.0;
+};
+
+/**
+ * Options for a layout pass
+ */
+struct LayoutOptions {
+    // Pool used to lay out independent sibling subtrees concurrently.
+    // nullptr (default) lays out the whole tree on the calling thread.
+    // Measure functions must be thread-safe when a pool is set.
+    LayoutThreadPool* threadPool = nullptr;
+    
+    // Subtrees with fewer nodes than this are laid out inline
+    size_t parallelThreshold = 256;
+    
+    // Two-phase measurement. When set, leaves with a MeasureFunc are not
+    // measured one by one: uncached measurements are collected over a whole
+    // pass, handed to this function in one call, and the pass is repeated
+    // with the results. The nodes' own MeasureFuncs are not called.
+    // Leaves whose MeasureProvider has a measureBatch are always measured
+    // this way, one call per provider, whether or not this is set.
+    BatchMeasureFunc batchMeasure;
+    
+    // Statistics of the pass are written here when set. Batched passes
+    // run more than once; their counters add up over the rounds.
+    LayoutStats* stats = nullptr;
+};
+
+/**
+ * Layout pass run in time slices
+ * 
+ * For trees too large to lay out within a frame (e.g. a document just
+ * imported): each runSlice() lays out containers until its budget is
+ * spent and returns, keeping the traversal state for the next slice, so
+ * the caller can yield to the run loop in between. Results are the same
+ * as calculateLayout's.
+ * 
+ * The tree's frames are only consistent once the job is complete; apply
+ * them then, all at once. Between slices the tree may be changed: the
+ * next slice sees that the root was marked dirty and starts the pass
+ * over. Nodes handed to a thread pool are finished before a slice
+ * returns. A container's own children are measured and placed in one
+ * step, as is laying out only dirty relayout boundaries.
+ */
+class LayoutJob {
+public:
+    /**
+     * @param root The root node of the tree; must outlive the job
+     */
+    LayoutJob(LayoutNode* root, float availableWidth, float availableHeight,
+              const LayoutOptions& options = LayoutOptions{});
+    
+    // Cancels a job that isn't complete
+    ~LayoutJob();
+    
+    /**
+     * Lay out until complete or until `budget` is spent
+     * @return true once the layout is complete
+     */
+    bool runSlice(std::chrono::microseconds budget);
+    
+    /**
+     * Stop without completing. Containers laid out so far keep their
+     * results; the rest of the tree stays dirty for the next pass.
+     */
+    void cancel();
+    
+    bool isComplete() const;
+    bool isCancelled() const;
+    
+    LayoutNode* getRoot() const;
+    size_t getSliceCount() const;
+    size_t getRestartCount() const;  // Passes started over after changes
+    
+private:
+    friend class LayoutEngine;
+    struct State;
+    std::unique_ptr<State> state_;
+    
+    // Non-copyable
+    LayoutJob(const LayoutJob&) = delete;
+    LayoutJob& operator=(const LayoutJob&) = delete;
+};
+
 /**
  * Layout Engine
  * 
@@ -27,10 +147,15 @@ public:
      * @param root The root node of the tree
      * @param availableWidth Available width for the root
      * @param availableHeight Available height for the root
+     * @param options Pass options; with a thread pool, nested containers
+     *                whose size along their parent's main axis is already
+     *                fixed are laid out in parallel. Results are identical
+     *                to a serial pass.
      */
     static void calculateLayout(LayoutNode* root, 
                                 float availableWidth, 
-                                float availableHeight);
+                                float availableHeight,
+                                const LayoutOptions& options = LayoutOptions{});
     
     /**
      * Apply computed layout to native views
@@ -47,29 +172,175 @@ public:
     
     static void applyLayout(LayoutNode* root, SetFrameFunc setFrameFunc);
     
+    /**
+     * Apply computed layout to the views whose frame changed
+     * 
+     * Compares each view's frame with the one last applied to it, and
+     * passes the changed ones to applyFrames in one call, through the
+     * reusable buffer `frames`. Content culled by the buffer's visible
+     * rects is deferred.
+     * 
+     * @return Number of frames applied
+     */
+    static size_t applyLayout(LayoutNode* root, FrameBuffer& frames, ApplyFramesFunc applyFrames);
+    
+    /**
+     * Lay out a dirty relayout boundary on its own
+     * 
+     * Reuses the constraints its parent gave it in the previous pass, so
+     * only the boundary's subtree is visited. calculateLayout does this
+     * automatically for dirty boundaries below a clean root. Once laid
+     * out, its ancestors stop reporting needsLayout() unless another
+     * dirty boundary is left below them.
+     * 
+     * @param node A relayout boundary marked dirty by one of its descendants
+     * @return false if the node can't be laid out alone (never laid out, or
+     *         dirty itself), or if its content changed its size after all;
+     *         its ancestors are then dirty and need a calculateLayout pass
+     */
+    static bool layoutBoundary(LayoutNode* node, const LayoutOptions& options = LayoutOptions{});
+    
+    /**
+     * Calculate layout for a subtree of a flat LayoutTree
+     * 
+     * Same algorithm as the LayoutNode overload, run directly over the
+     * tree's contiguous arrays.
+     * 
+     * @param tree The tree holding the nodes
+     * @param root Index of the subtree root
+     * @param availableWidth Available width for the root
+     * @param availableHeight Available height for the root
+     */
+    static void calculateLayout(LayoutTree& tree, NodeId root,
+                                float availableWidth,
+                                float availableHeight);
+    
+    /**
+     * Apply computed layout of a LayoutTree subtree to native views
+     */
+    static void applyLayout(const LayoutTree& tree, NodeId root, SetFrameFunc setFrameFunc);
+    static size_t applyLayout(const LayoutTree& tree, NodeId root, FrameBuffer& frames,
+                              ApplyFramesFunc applyFrames);
+    
 private:
+    friend class LayoutJob;
+    
     // Internal layout algorithm
     static void layoutNode(LayoutNode* node, 
                           float availableWidth, MeasureMode widthMode,
-                          float availableHeight, MeasureMode heightMode);
+                          float availableHeight, MeasureMode heightMode,
+                          LayoutPass& pass);
+    
+    // Steps of layoutNode: restore a clean root (after laying out its dirty
+    // relayout boundaries), resolve the node's own frame or measure it as
+    // a leaf, and, after its children, lay out absolute children and cache
+    static bool reuseRootLayout(LayoutNode* node, const LayoutConstraints& constraints,
+                                LayoutPass& pass);
+    static void beginNode(LayoutNode* node, const LayoutConstraints& constraints,
+                          LayoutPass& pass);
+    static void finishNode(LayoutNode* node, const LayoutConstraints& constraints,
+                           size_t misses, LayoutPass& pass);
     
     // Layout for flex containers
     static void layoutFlexContainer(LayoutNode* node,
                                     float availableWidth, MeasureMode widthMode,
-                                    float availableHeight, MeasureMode heightMode);
+                                    float availableHeight, MeasureMode heightMode,
+                                    LayoutPass& pass);
+    
+    // Nested flex containers are laid out from an explicit per-thread
+    // stack of frames instead of recursively, so deep trees can't
+    // overflow the call stack
+    struct FlexFrame;
+    static std::vector<FlexFrame>& flexStack();
+    static void layoutContainers(LayoutNode* root, const LayoutConstraints& constraints,
+                                 bool cacheResult, LayoutPass& pass, size_t depth);
+    
+    // Run the frames above `base` until the stack is back to it, or until
+    // the deadline (of a LayoutJob slice) passes; false if stopped early
+    struct Deadline;
+    static bool runContainers(std::vector<FlexFrame>& stack, size_t base, LayoutPass& pass,
+                              const Deadline* deadline);
+    
+    // A LayoutJob slice; true once the job is complete
+    static bool runJob(LayoutJob::State& job, std::chrono::microseconds budget);
+    static bool runJobRounds(LayoutJob::State& job, const Deadline& deadline);
+    static void beginContainer(std::vector<FlexFrame>& stack, LayoutNode* node,
+                               const LayoutConstraints& constraints, bool cacheResult,
+                               LayoutPass& pass, size_t depth);
+    static void finishContainer(LayoutNode* node, bool cacheResult,
+                                const LayoutConstraints& constraints, size_t misses,
+                                LayoutPass& pass);
+    static bool measureFlexChildren(FlexFrame& frame, LayoutPass& pass);
+    static LayoutNode* positionFlexChildren(FlexFrame& frame, LayoutPass& pass);
+    static void advanceFlexChild(FlexFrame& frame, LayoutNode* child, float childMainSize,
+                                 bool laidOut);
+    static void endFlexContainer(FlexFrame& frame);
+    
+    // Layout for grid containers, shared by both tree representations
+    // through an access adapter (NodeGridAccess, TreeGridAccess)
+    struct NodeGridAccess;
+    struct TreeGridAccess;
+    template <typename Access>
+    static void layoutGridContainer(const Access& access, const Style& style,
+                                    LayoutResult& layout);
+    
+    // Layout a nested container, reusing its previous result when the
+    // subtree is clean and laid out under the same constraints
+    static void layoutChildContainer(LayoutNode* node,
+                                     float availableWidth, MeasureMode widthMode,
+                                     float availableHeight, MeasureMode heightMode,
+                                     LayoutPass& pass, size_t depth);
+    
+    // Lay out the dirty relayout boundaries below a clean node
+    static void layoutDirtyBoundaries(LayoutNode* node, LayoutPass& pass);
+    static bool layoutBoundary(LayoutNode* node, LayoutPass& pass);
+    
+    // Incremental layout helpers
+    static bool canReuseLayout(const LayoutNode* node, const LayoutConstraints& constraints);
+    static void restoreCachedLayout(LayoutNode* node);
+    static void storeCachedLayout(LayoutNode* node, const LayoutConstraints& constraints);
+    
+    // Statistics: a node laid out, or a clean one whose cached layout was restored
+    static void countVisit(LayoutNode* node, LayoutPass& pass);
+    static void countSkip(LayoutNode* node, LayoutPass& pass);
     
     // Layout for absolute positioned nodes
-    static void layoutAbsoluteChildren(LayoutNode* node);
+    static void layoutAbsoluteChildren(LayoutNode* node, LayoutPass& pass);
+    
+    // Measure a leaf, or queue the measurement when batching
+    static Size measureLeaf(LayoutNode* node,
+                            float width, MeasureMode widthMode,
+                            float height, MeasureMode heightMode,
+                            LayoutPass& pass);
+    
+    // Hand queued measurements to the batch measurers and cache the results.
+    // Returns true if there were any, i.e. the pass must run again.
+    static bool measurePending(LayoutPass& pass);
+    
+    // Measure requests of one batching provider (or none) in one call
+    static void measureBatch(MeasureRequest* requests, size_t count,
+                             const LayoutOptions& options);
     
     // Resolve size constraints
     static float resolveWidth(LayoutNode* node, float parentWidth);
     static float resolveHeight(LayoutNode* node, float parentHeight);
     
-    // Apply layout recursively to native views
-    static void applyLayoutRecursive(LayoutNode* node, 
-                                     SetFrameFunc setFrameFunc,
-                                     float parentAbsX, 
-                                     float parentAbsY);
+    // Flat LayoutTree counterparts of layoutNode/layoutFlexContainer/layoutAbsoluteChildren
+    static void layoutTreeNode(LayoutTree& tree, NodeId node,
+                               float availableWidth, MeasureMode widthMode,
+                               float availableHeight, MeasureMode heightMode);
+    static void layoutTreeFlexContainer(LayoutTree& tree, NodeId root);
+    struct TreeFlexFrame;
+    static std::vector<TreeFlexFrame>& treeFlexStack();
+    static void beginTreeContainer(LayoutTree& tree, std::vector<TreeFlexFrame>& stack,
+                                   NodeId node);
+    static bool measureTreeFlexChildren(LayoutTree& tree, TreeFlexFrame& frame,
+                                        const Style& style);
+    static NodeId positionTreeFlexChildren(LayoutTree& tree, TreeFlexFrame& frame);
+    static void advanceTreeFlexChild(LayoutTree& tree, TreeFlexFrame& frame, NodeId child,
+                                     float childMainSize, bool laidOut);
+    static void endTreeFlexContainer(LayoutTree& tree, TreeFlexFrame& frame);
+    static void layoutTreeAbsoluteChildren(LayoutTree& tree, NodeId node);
 };
 
 } // namespace obsidian::layout
@@ -0,0 +1,157 @@
+/**
+ * Obsidian Layout Engine - Frame Buffer Implementation
+ */
+
+#include "frame_buffer.h"
+
+namespace obsidian::layout {
+
+namespace {
+
+bool intersects(const Rect& rect, float x, float y, float width, float height) {
+    return x <= rect.x + rect.width && x + width >= rect.x &&
+           y <= rect.y + rect.height && y + height >= rect.y;
+}
+
+} // namespace
+
+void FrameBuffer::collectChanges(LayoutNode* root) {
+    changes_.clear();
+    culls_.clear();
+
+    // Origin of the current node's parent, relative to the root's parent
+    const LayoutNode* parent = root->getParent();
+    float parentX = 0.0f;
+    float parentY = 0.0f;
+
+    LayoutNode* node = root;
+    while (node) {
+        // Climb out of finished subtrees to the node's parent
+        while (parent != node->getParent()) {
+            if (!culls_.empty() && culls_.back().container == parent) {
+                culls_.pop_back();
+            }
+            parentX -= parent->getLayout().left;
+            parentY -= parent->getLayout().top;
+            parent = parent->getParent();
+        }
+
+        const LayoutResult& layout = node->getLayout();
+        float x = parentX + layout.left;
+        float y = parentY + layout.top;
+        bool visible = culls_.empty() ||
+                       intersects(culls_.back().visible, x - culls_.back().x, y - culls_.back().y,
+                                  layout.width, layout.height);
+
+        if (visible) {
+            if (void* view = node->getNativeView()) {
+                ViewFrame frame{view, layout.left, layout.top, layout.width, layout.height};
+                if (frame != node->appliedFrame_) {
+                    changes_.push_back(frame);
+                    node->appliedFrame_ = frame;
+                }
+            }
+            if (!viewports_.empty() && node->getChildCount() > 0) {
+                for (const Viewport& viewport : viewports_) {
+                    if (viewport.container == node) {
+                        culls_.push_back({node, x, y, viewport.visible});
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Culled subtrees are skipped, keeping their deferred frames
+        LayoutNode* next = node->nextInPreOrder(root, visible);
+        if (next && next->getParent() == node) {
+            parent = node;
+            parentX = x;
+            parentY = y;
+        }
+        node = next;
+    }
+}
+
+void FrameBuffer::collectChanges(const LayoutTree& tree, NodeId root) {
+    changes_.clear();
+    if (root >= tree.size()) return;
+
+    if (tree_ != &tree) {
+        tree_ = &tree;
+        treeApplied_.clear();
+    }
+    if (treeApplied_.size() < tree.size()) {
+        treeApplied_.resize(tree.size());
+    }
+
+    // Pre-order walk over the index links
+    NodeId node = root;
+    while (true) {
+        if (void* view = tree.getNativeView(node)) {
+            const LayoutResult& layout = tree.getLayout(node);
+            ViewFrame frame{view, layout.left, layout.top, layout.width, layout.height};
+            if (frame != treeApplied_[node]) {
+                changes_.push_back(frame);
+                treeApplied_[node] = frame;
+            }
+        }
+
+        if (tree.getFirstChild(node) != kInvalidNodeId) {
+            node = tree.getFirstChild(node);
+            continue;
+        }
+        while (node != root && tree.getNextSibling(node) == kInvalidNodeId) {
+            node = tree.getParent(node);
+        }
+        if (node == root) break;
+        node = tree.getNextSibling(node);
+    }
+}
+
+size_t FrameBuffer::apply(ApplyFramesFunc applyFrames) const {
+    if (!applyFrames) return 0;
+
+    if (!changes_.empty()) {
+        applyFrames(changes_.data(), changes_.size());
+    }
+    return changes_.size();
+}
+
+size_t FrameBuffer::apply(SetViewFrameFunc setFrame) const {
+    if (!setFrame) return 0;
+
+    for (const ViewFrame& frame : changes_) {
+        setFrame(frame.view, frame.x, frame.y, frame.width, frame.height);
+    }
+    return changes_.size();
+}
+
+void FrameBuffer::setVisibleRect(const LayoutNode* container, const Rect& visible, float margin) {
+    Rect area{visible.x - margin, visible.y - margin,
+              visible.width + 2.0f * margin, visible.height + 2.0f * margin};
+    for (Viewport& viewport : viewports_) {
+        if (viewport.container == container) {
+            viewport.visible = area;
+            return;
+        }
+    }
+    viewports_.push_back({container, area});
+}
+
+void FrameBuffer::clearVisibleRect(const LayoutNode* container) {
+    std::erase_if(viewports_, [container](const Viewport& viewport) {
+        return viewport.container == container;
+    });
+}
+
+void FrameBuffer::invalidate(LayoutNode* root) {
+    for (LayoutNode* node = root; node; node = node->nextInPreOrder(root)) {
+        node->appliedFrame_ = ViewFrame{};
+    }
+}
+
+void FrameBuffer::invalidate() {
+    treeApplied_.clear();
+}
+
+} // namespace obsidian::layout
@@ -0,0 +1,130 @@
+/**
+ * Obsidian Layout Engine - Frame Buffer
+ *
+ * Applies computed frames to native views in batches, skipping views
+ * whose frame didn't change. Each node remembers the frame last applied
+ * to its view; collecting a subtree compares every view's computed frame
+ * against it and writes only the changed ones into a contiguous buffer
+ * of records, which goes to the platform in one call.
+ *
+ * Frames set on a view by other code are not seen: such a view is set
+ * again only once its computed frame changes, or after invalidate().
+ *
+ * Scroll containers can be given a visible rect. Content outside it is
+ * culled: its frames are deferred, and its subtrees aren't visited.
+ * Deferred frames still differ from the applied ones, so they are
+ * collected once they scroll into view.
+ */
+
+#pragma once
+
+#include "node.h"
+#include "layout_tree.h"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace obsidian::layout {
+
+/**
+ * Sets the frames of a batch of views in one call
+ */
+using ApplyFramesFunc = void(*)(const ViewFrame* frames, size_t count);
+
+/**
+ * Sets the frame of a single view (same signature as LayoutEngine::SetFrameFunc)
+ */
+using SetViewFrameFunc = void(*)(void* nativeView,
+                                 float x, float y,
+                                 float width, float height);
+
+/**
+ * Frame Buffer
+ *
+ * Reusable across passes and roots; allocation-free once its buffer has
+ * grown to the largest batch.
+ */
+class FrameBuffer {
+public:
+    /**
+     * Collect the frames in a subtree that differ from the ones last
+     * applied, in pre-order
+     * Replaces the previously collected changes and records them as
+     * applied, so pass them to the platform right after.
+     */
+    void collectChanges(LayoutNode* root);
+
+    /**
+     * Same for a flat LayoutTree subtree
+     * The frames applied to a tree's views are remembered in the buffer,
+     * by node index; use one buffer per tree.
+     */
+    void collectChanges(const LayoutTree& tree, NodeId root);
+
+    /**
+     * Frames collected last
+     */
+    std::span<const ViewFrame> getChanges() const { return changes_; }
+
+    /**
+     * Apply the collected frames, in one call or one call per view
+     * @return Number of frames applied
+     */
+    size_t apply(ApplyFramesFunc applyFrames) const;
+    size_t apply(SetViewFrameFunc setFrame) const;
+
+    /**
+     * Cull the content of a scroll container to its visible rect
+     * @param container Node whose children are the scrolled content
+     * @param visible Visible part of the content, in the container's
+     *                coordinates (the content offset and viewport size)
+     * @param margin Distance beyond each edge of `visible` within which
+     *               views are still updated, so they're in place before
+     *               they scroll in
+     * A node is culled with its subtree when its frame lies entirely
+     * outside; content overflowing its parent is culled with the parent.
+     * Nested containers cull against their own rect only. The container
+     * is only compared by address: clear it before destroying the node.
+     */
+    void setVisibleRect(const LayoutNode* container, const Rect& visible, float margin = 0.0f);
+    void clearVisibleRect(const LayoutNode* container);
+    
+    /**
+     * Forget the frames applied to a subtree's views, so the next
+     * collection includes every view (e.g. after they were recreated)
+     */
+    static void invalidate(LayoutNode* root);
+
+    /**
+     * Forget the frames applied to LayoutTree views
+     */
+    void invalidate();
+
+private:
+    // Visible area of a scroll container's content, margin included
+    struct Viewport {
+        const LayoutNode* container = nullptr;
+        Rect visible;
+    };
+    
+    // Culling below a container being walked; its origin is relative
+    // to the parent of the walk's root
+    struct Cull {
+        const LayoutNode* container = nullptr;
+        float x = 0.0f;
+        float y = 0.0f;
+        Rect visible;
+    };
+    
+    std::vector<ViewFrame> changes_;
+    
+    // Few at a time, so searched linearly
+    std::vector<Viewport> viewports_;
+    std::vector<Cull> culls_;
+
+    // Frames applied to views of a flat tree, by node index
+    const LayoutTree* tree_ = nullptr;
+    std::vector<ViewFrame> treeApplied_;
+};
+
+} // namespace obsidian::layout
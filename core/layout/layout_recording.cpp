@@ -0,0 +1,546 @@
+/**
+ * Obsidian Layout Engine - Layout Recording Implementation
+ *
+ * File format, version 1. All integers and floats are little-endian;
+ * floats are IEEE 754 single precision.
+ *
+ *   header        "OBLR", u16 version, u16 reserved,
+ *                 f32 available width, f32 available height,
+ *                 u32 style count, u32 node count, u32 measurement count
+ *   style         u8 display, flexDirection, justifyContent, alignItems,
+ *                 alignSelf, positionType; f32 flexGrow, flexShrink;
+ *                 value flexBasis; tracks gridColumns, gridRows;
+ *                 u16 gridColumn, gridRow, gridColumnSpan, gridRowSpan;
+ *                 value position[4], width, height, minWidth, minHeight,
+ *                 maxWidth, maxHeight, padding[4], margin[4];
+ *                 f32 gap, aspectRatio
+ *   node          u32 style index, u32 child count, u8 flags (1: measured),
+ *                 u8 measurement count, f32 left, top, width, height
+ *   measurement   f32 width, u8 width mode, f32 height, u8 height mode,
+ *                 f32 measured width, f32 measured height
+ *
+ *   value         f32 value, u8 unit
+ *   tracks        u16 count, then u8 type and f32 value per track
+ *
+ * Nodes are in pre-order; a node's children follow it. Measurements are
+ * grouped by node, in node order, oldest first.
+ */
+
+#include "layout_recording.h"
+#include "engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+namespace obsidian::layout {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'O', 'B', 'L', 'R'};
+constexpr uint16_t kVersion = 1;
+
+constexpr size_t kHeaderSize = 4 + 2 + 2 + 4 + 4 + 4 + 4 + 4;
+constexpr size_t kNodeSize = 4 + 4 + 1 + 1 + 4 * 4;
+constexpr size_t kMeasurementSize = 4 + 1 + 4 + 1 + 4 + 4;
+constexpr size_t kMinStyleSize = 6 + 4 * 2 + 5 + 2 * 2 + 2 * 4 + 5 * 18 + 4 * 2;
+
+constexpr uint8_t kMeasuredFlag = 1;
+
+class Writer {
+public:
+    explicit Writer(std::vector<uint8_t>& out) : out_(out) {}
+
+    void u8(uint8_t value) { out_.push_back(value); }
+
+    void u16(uint16_t value) {
+        out_.push_back(static_cast<uint8_t>(value));
+        out_.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void u32(uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out_.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void f32(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u32(bits);
+    }
+
+    void value(const LayoutValue& value) {
+        f32(value.value);
+        u8(static_cast<uint8_t>(value.unit));
+    }
+
+    void tracks(const GridTracks& tracks) {
+        std::span<const GridTrack> list = tracks.tracks();
+        u16(static_cast<uint16_t>(list.size()));
+        for (const GridTrack& track : list) {
+            u8(static_cast<uint8_t>(track.type));
+            f32(track.value);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+// Reads past the end or out-of-range enums clear ok() instead of failing
+// right away; callers check once per record.
+class Reader {
+public:
+    explicit Reader(std::span<const uint8_t> data) : data_(data) {}
+
+    bool ok() const { return ok_; }
+    size_t remaining() const { return data_.size() - pos_; }
+
+    uint8_t u8() {
+        if (!take(1)) return 0;
+        return data_[pos_ - 1];
+    }
+
+    uint16_t u16() {
+        if (!take(2)) return 0;
+        const uint8_t* p = &data_[pos_ - 2];
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    uint32_t u32() {
+        if (!take(4)) return 0;
+        const uint8_t* p = &data_[pos_ - 4];
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // An enum whose last enumerator is `last`
+    template <typename Enum>
+    Enum enumeration(Enum last) {
+        uint8_t raw = u8();
+        if (raw > static_cast<uint8_t>(last)) {
+            ok_ = false;
+            return Enum{};
+        }
+        return static_cast<Enum>(raw);
+    }
+
+    LayoutValue value() {
+        LayoutValue result;
+        result.value = f32();
+        result.unit = enumeration(Unit::Percent);
+        return result;
+    }
+
+    GridTracks tracks() {
+        uint16_t count = u16();
+        if (count == 0) return {};
+        if (remaining() < count * 5u) {
+            ok_ = false;
+            return {};
+        }
+        std::vector<GridTrack> list(count);
+        for (GridTrack& track : list) {
+            track.type = enumeration(GridTrackType::Fraction);
+            track.value = f32();
+        }
+        return GridTracks(std::span<const GridTrack>(list));
+    }
+
+private:
+    bool take(size_t size) {
+        if (!ok_ || remaining() < size) {
+            ok_ = false;
+            return false;
+        }
+        pos_ += size;
+        return true;
+    }
+
+    std::span<const uint8_t> data_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+void writeStyle(Writer& out, const Style& style) {
+    out.u8(static_cast<uint8_t>(style.display));
+    out.u8(static_cast<uint8_t>(style.flexDirection));
+    out.u8(static_cast<uint8_t>(style.justifyContent));
+    out.u8(static_cast<uint8_t>(style.alignItems));
+    out.u8(static_cast<uint8_t>(style.alignSelf));
+    out.u8(static_cast<uint8_t>(style.positionType));
+    out.f32(style.flexGrow);
+    out.f32(style.flexShrink);
+    out.value(style.flexBasis);
+    out.tracks(style.gridColumns);
+    out.tracks(style.gridRows);
+    out.u16(style.gridColumn);
+    out.u16(style.gridRow);
+    out.u16(style.gridColumnSpan);
+    out.u16(style.gridRowSpan);
+    for (const LayoutValue& value : style.position) out.value(value);
+    out.value(style.width);
+    out.value(style.height);
+    out.value(style.minWidth);
+    out.value(style.minHeight);
+    out.value(style.maxWidth);
+    out.value(style.maxHeight);
+    for (const LayoutValue& value : style.padding) out.value(value);
+    for (const LayoutValue& value : style.margin) out.value(value);
+    out.f32(style.gap);
+    out.f32(style.aspectRatio);
+}
+
+Style readStyle(Reader& in) {
+    Style style;
+    style.display = in.enumeration(Display::Grid);
+    style.flexDirection = in.enumeration(FlexDirection::RowReverse);
+    style.justifyContent = in.enumeration(JustifyContent::SpaceEvenly);
+    style.alignItems = in.enumeration(AlignItems::Stretch);
+    style.alignSelf = in.enumeration(AlignSelf::Stretch);
+    style.positionType = in.enumeration(PositionType::Absolute);
+    style.flexGrow = in.f32();
+    style.flexShrink = in.f32();
+    style.flexBasis = in.value();
+    style.gridColumns = in.tracks();
+    style.gridRows = in.tracks();
+    style.gridColumn = in.u16();
+    style.gridRow = in.u16();
+    style.gridColumnSpan = in.u16();
+    style.gridRowSpan = in.u16();
+    for (LayoutValue& value : style.position) value = in.value();
+    style.width = in.value();
+    style.height = in.value();
+    style.minWidth = in.value();
+    style.minHeight = in.value();
+    style.maxWidth = in.value();
+    style.maxHeight = in.value();
+    for (LayoutValue& value : style.padding) value = in.value();
+    for (LayoutValue& value : style.margin) value = in.value();
+    style.gap = in.f32();
+    style.aspectRatio = in.f32();
+    return style;
+}
+
+// Fit a recorded size to constraints it wasn't recorded under
+float fitToConstraint(float size, float constraint, MeasureMode mode) {
+    switch (mode) {
+        case MeasureMode::Exactly: return constraint;
+        case MeasureMode::AtMost: return std::min(size, constraint);
+        case MeasureMode::Undefined: return size;
+    }
+    return size;
+}
+
+} // namespace
+
+const MeasureProvider LayoutRecording::kRecordedProvider{
+    &LayoutRecording::measureRecorded,
+    nullptr,
+    nullptr
+};
+
+LayoutRecording::~LayoutRecording() {
+    clear();
+}
+
+LayoutRecording LayoutRecording::capture(LayoutNode* root, float availableWidth, float availableHeight) {
+    LayoutRecording recording;
+    recording.availableWidth_ = availableWidth;
+    recording.availableHeight_ = availableHeight;
+    if (!root) return recording;
+
+    // Interned styles are shared, so equal styles mostly share an address
+    std::unordered_map<const Style*, uint32_t> styleIndex;
+
+    for (LayoutNode* node = root; node; node = node->nextInPreOrder(root)) {
+        const Style& style = std::as_const(*node).getStyle();
+        auto [it, inserted] = styleIndex.try_emplace(&style, static_cast<uint32_t>(recording.styles_.size()));
+        if (inserted) {
+            recording.styles_.push_back(style);
+        }
+
+        const LayoutResult& layout = node->getLayout();
+        RecordedNode recorded;
+        recorded.style = it->second;
+        recorded.childCount = static_cast<uint32_t>(node->getChildCount());
+        recorded.firstMeasurement = static_cast<uint32_t>(recording.measurements_.size());
+        recorded.measured = node->measureProvider_ != nullptr;
+        recorded.left = layout.left;
+        recorded.top = layout.top;
+        recorded.width = layout.width;
+        recorded.height = layout.height;
+
+        if (recorded.measured) {
+            // Oldest first: once full, the cache overwrites from nextMeasurement on
+            const LayoutCache& cache = node->cache_;
+            size_t start = (cache.measurementCount == LayoutCache::kMaxMeasurements) ? cache.nextMeasurement : 0;
+            for (size_t i = 0; i < cache.measurementCount; ++i) {
+                const LayoutCache::Measurement& entry =
+                    cache.measurements[(start + i) % LayoutCache::kMaxMeasurements];
+                recording.measurements_.push_back({entry.constraints, entry.size});
+            }
+
+            if (cache.measurementCount == 0) {
+                // Laid out before capture but evicted, or never laid out
+                LayoutConstraints constraints{0.0f, MeasureMode::Undefined, 0.0f, MeasureMode::Undefined};
+                Size size;
+                if (node->measureProvider_->measure) {
+                    size = node->measureProvider_->measure(node->measureContext_, 0.0f, MeasureMode::Undefined,
+                                                           0.0f, MeasureMode::Undefined);
+                } else {
+                    MeasureRequest request{node, constraints, {}};
+                    node->measureProvider_->measureBatch(&request, 1);
+                    size = request.result;
+                }
+                recording.measurements_.push_back({constraints, size});
+            }
+            recorded.measurementCount = static_cast<uint8_t>(recording.measurements_.size() - recorded.firstMeasurement);
+        }
+
+        recording.nodes_.push_back(recorded);
+    }
+    return recording;
+}
+
+std::vector<uint8_t> LayoutRecording::serialize() const {
+    std::vector<uint8_t> data;
+    data.reserve(kHeaderSize + styles_.size() * kMinStyleSize +
+                 nodes_.size() * kNodeSize + measurements_.size() * kMeasurementSize);
+    Writer out(data);
+
+    for (uint8_t byte : kMagic) out.u8(byte);
+    out.u16(kVersion);
+    out.u16(0);
+    out.f32(availableWidth_);
+    out.f32(availableHeight_);
+    out.u32(static_cast<uint32_t>(styles_.size()));
+    out.u32(static_cast<uint32_t>(nodes_.size()));
+    out.u32(static_cast<uint32_t>(measurements_.size()));
+
+    for (const Style& style : styles_) {
+        writeStyle(out, style);
+    }
+
+    for (const RecordedNode& node : nodes_) {
+        out.u32(node.style);
+        out.u32(node.childCount);
+        out.u8(node.measured ? kMeasuredFlag : 0);
+        out.u8(node.measurementCount);
+        out.f32(node.left);
+        out.f32(node.top);
+        out.f32(node.width);
+        out.f32(node.height);
+    }
+
+    for (const Measurement& measurement : measurements_) {
+        out.f32(measurement.constraints.width);
+        out.u8(static_cast<uint8_t>(measurement.constraints.widthMode));
+        out.f32(measurement.constraints.height);
+        out.u8(static_cast<uint8_t>(measurement.constraints.heightMode));
+        out.f32(measurement.size.width);
+        out.f32(measurement.size.height);
+    }
+    return data;
+}
+
+bool LayoutRecording::deserialize(std::span<const uint8_t> data) {
+    clear();
+
+    Reader in(data);
+    for (uint8_t byte : kMagic) {
+        if (in.u8() != byte) return false;
+    }
+    if (in.u16() != kVersion) return false;
+    in.u16();
+    float availableWidth = in.f32();
+    float availableHeight = in.f32();
+    uint32_t styleCount = in.u32();
+    uint32_t nodeCount = in.u32();
+    uint32_t measurementCount = in.u32();
+    if (!in.ok()) return false;
+
+    // Reject counts the data can't hold before allocating for them
+    uint64_t minimumSize = uint64_t(styleCount) * kMinStyleSize + uint64_t(nodeCount) * kNodeSize +
+                           uint64_t(measurementCount) * kMeasurementSize;
+    if (minimumSize > in.remaining()) return false;
+
+    std::vector<Style> styles;
+    styles.reserve(styleCount);
+    for (uint32_t i = 0; i < styleCount; ++i) {
+        styles.push_back(readStyle(in));
+        if (!in.ok()) return false;
+    }
+
+    // Child counts must describe one tree: every node but the root fills
+    // a child slot of the nearest ancestor that has one left
+    std::vector<RecordedNode> nodes;
+    nodes.reserve(nodeCount);
+    std::vector<uint32_t> openSlots;
+    uint64_t measurementTotal = 0;
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        RecordedNode node;
+        node.style = in.u32();
+        node.childCount = in.u32();
+        uint8_t flags = in.u8();
+        node.measurementCount = in.u8();
+        node.left = in.f32();
+        node.top = in.f32();
+        node.width = in.f32();
+        node.height = in.f32();
+        if (!in.ok() || node.style >= styleCount || (flags & ~kMeasuredFlag) != 0) return false;
+
+        node.measured = (flags & kMeasuredFlag) != 0;
+        if (!node.measured && node.measurementCount != 0) return false;
+        node.firstMeasurement = static_cast<uint32_t>(measurementTotal);
+        measurementTotal += node.measurementCount;
+
+        if (i > 0) {
+            while (!openSlots.empty() && openSlots.back() == 0) openSlots.pop_back();
+            if (openSlots.empty()) return false;
+            --openSlots.back();
+        }
+        if (node.childCount >= nodeCount) return false;
+        openSlots.push_back(node.childCount);
+        nodes.push_back(node);
+    }
+    for (uint32_t slots : openSlots) {
+        if (slots != 0) return false;
+    }
+    if (measurementTotal != measurementCount) return false;
+
+    std::vector<Measurement> measurements(measurementCount);
+    for (Measurement& measurement : measurements) {
+        measurement.constraints.width = in.f32();
+        measurement.constraints.widthMode = in.enumeration(MeasureMode::AtMost);
+        measurement.constraints.height = in.f32();
+        measurement.constraints.heightMode = in.enumeration(MeasureMode::AtMost);
+        measurement.size.width = in.f32();
+        measurement.size.height = in.f32();
+    }
+    if (!in.ok() || in.remaining() != 0) return false;
+
+    availableWidth_ = availableWidth;
+    availableHeight_ = availableHeight;
+    styles_ = std::move(styles);
+    nodes_ = std::move(nodes);
+    measurements_ = std::move(measurements);
+    return true;
+}
+
+bool LayoutRecording::save(const std::string& path) const {
+    std::vector<uint8_t> data = serialize();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+bool LayoutRecording::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        clear();
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return deserialize(data);
+}
+
+LayoutNode* LayoutRecording::instantiate() {
+    // Drop a previous instance first; leaves_ is rebuilt below
+    for (auto& node : tree_) node.reset();
+    tree_.clear();
+    leaves_.clear();
+    if (nodes_.empty()) return nullptr;
+
+    leaves_.resize(nodes_.size());
+    tree_.reserve(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        const RecordedNode& recorded = nodes_[i];
+        auto node = std::make_unique<LayoutNode>();
+        node->setStyle(styles_[recorded.style]);
+        if (recorded.measured) {
+            leaves_[i] = {measurements_.data() + recorded.firstMeasurement, recorded.measurementCount};
+            node->setMeasureProvider(&kRecordedProvider, &leaves_[i]);
+        }
+        tree_.push_back(std::move(node));
+    }
+
+    // Children of each node, grouped by parent in node order
+    std::vector<size_t> firstChild(nodes_.size() + 1, 0);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        firstChild[i + 1] = firstChild[i] + nodes_[i].childCount;
+    }
+    std::vector<LayoutNode*> children(nodes_.size() - 1);
+    std::vector<size_t> filled(nodes_.size(), 0);
+    std::vector<size_t> parents;  // Ancestors with children still to place
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (i > 0) {
+            while (filled[parents.back()] == nodes_[parents.back()].childCount) parents.pop_back();
+            size_t parent = parents.back();
+            children[firstChild[parent] + filled[parent]++] = tree_[i].get();
+        }
+        if (nodes_[i].childCount > 0) parents.push_back(i);
+    }
+
+    // Attached bottom-up, so each parent is dirtied once, before it has a parent
+    for (size_t i = nodes_.size(); i-- > 0;) {
+        if (nodes_[i].childCount == 0) continue;
+        tree_[i]->setChildren(std::span<LayoutNode* const>(children.data() + firstChild[i], nodes_[i].childCount));
+    }
+    return tree_.front().get();
+}
+
+size_t LayoutRecording::countMismatches(float tolerance) const {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < tree_.size(); ++i) {
+        const LayoutResult& layout = tree_[i]->getLayout();
+        const RecordedNode& recorded = nodes_[i];
+        auto differs = [tolerance](float a, float b) { return !(std::abs(a - b) <= tolerance); };
+        if (differs(layout.left, recorded.left) || differs(layout.top, recorded.top) ||
+            differs(layout.width, recorded.width) || differs(layout.height, recorded.height)) {
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+Size LayoutRecording::measureRecorded(void* context, float width, MeasureMode widthMode,
+                                      float height, MeasureMode heightMode) {
+    const RecordedLeaf& leaf = *static_cast<const RecordedLeaf*>(context);
+    LayoutConstraints constraints{width, widthMode, height, heightMode};
+    for (size_t i = 0; i < leaf.count; ++i) {
+        if (leaf.measurements[i].constraints == constraints) {
+            return leaf.measurements[i].size;
+        }
+    }
+
+    Size size = leaf.count ? leaf.measurements[leaf.count - 1].size : Size{0.0f, 0.0f};
+    return {fitToConstraint(size.width, width, widthMode),
+            fitToConstraint(size.height, height, heightMode)};
+}
+
+void LayoutRecording::clear() {
+    // Root first: each node lets go of its children, so none is dirtied
+    for (auto& node : tree_) node.reset();
+    tree_.clear();
+    leaves_.clear();
+    styles_.clear();
+    nodes_.clear();
+    measurements_.clear();
+    availableWidth_ = 0.0f;
+    availableHeight_ = 0.0f;
+}
+
+} // namespace obsidian::layout
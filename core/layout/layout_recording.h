@@ -0,0 +1,124 @@
+/**
+ * Obsidian Layout Engine - Layout Recording
+ *
+ * Captures a laid-out LayoutNode tree into a compact file: its structure,
+ * its styles (each distinct one stored once), the sizes its measured
+ * leaves returned under each set of constraints, and the frames it got.
+ * Loading the file rebuilds the tree with leaves that answer from the
+ * recorded sizes, so the layout of a real screen can be replayed,
+ * profiled and regression-tested anywhere, without the native views or
+ * text system that measured it.
+ *
+ * The file format is little-endian and versioned; see layout_recording.cpp.
+ */
+
+#pragma once
+
+#include "node.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace obsidian::layout {
+
+/**
+ * Layout Recording
+ *
+ * One captured tree and the size it was laid out at. Owns the nodes it
+ * instantiates; they live until the recording is destroyed, loaded
+ * again or instantiated again.
+ */
+class LayoutRecording {
+public:
+    LayoutRecording() = default;
+    ~LayoutRecording();
+
+    LayoutRecording(LayoutRecording&&) = default;
+    LayoutRecording& operator=(LayoutRecording&&) = default;
+
+    /**
+     * Capture a tree right after it was laid out at a size. Measurements
+     * come from the leaves' measurement caches; a leaf with none cached
+     * is measured once without constraints.
+     */
+    static LayoutRecording capture(LayoutNode* root, float availableWidth, float availableHeight);
+
+    /**
+     * Encode to / decode from the file format. Decoding checks every
+     * count and enum, and leaves the recording empty on failure.
+     */
+    std::vector<uint8_t> serialize() const;
+    bool deserialize(std::span<const uint8_t> data);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    /**
+     * Build the recorded tree, dirty and ready for calculateLayout().
+     * Leaves return the recorded size for constraints seen at capture;
+     * others get the last recorded size, fitted to the constraints.
+     * @return The root, or nullptr for an empty recording
+     */
+    LayoutNode* instantiate();
+
+    /**
+     * Nodes of the instantiated tree whose frame differs from the
+     * captured one by more than `tolerance` on any edge
+     */
+    size_t countMismatches(float tolerance = 0.01f) const;
+
+    bool isEmpty() const { return nodes_.empty(); }
+    size_t getNodeCount() const { return nodes_.size(); }
+    size_t getStyleCount() const { return styles_.size(); }
+    size_t getMeasurementCount() const { return measurements_.size(); }
+    float getAvailableWidth() const { return availableWidth_; }
+    float getAvailableHeight() const { return availableHeight_; }
+
+    // Instantiated nodes, in pre-order (empty until instantiate())
+    const std::vector<std::unique_ptr<LayoutNode>>& getNodes() const { return tree_; }
+
+private:
+    struct Measurement {
+        LayoutConstraints constraints;
+        Size size;
+    };
+
+    struct RecordedNode {
+        uint32_t style = 0;
+        uint32_t childCount = 0;
+        uint32_t firstMeasurement = 0;
+        uint8_t measurementCount = 0;
+        bool measured = false;
+        float left = 0.0f;
+        float top = 0.0f;
+        float width = 0.0f;
+        float height = 0.0f;
+    };
+
+    // Context of an instantiated leaf: its recorded measurements
+    struct RecordedLeaf {
+        const Measurement* measurements = nullptr;
+        size_t count = 0;
+    };
+
+    static Size measureRecorded(void* context, float width, MeasureMode widthMode,
+                                float height, MeasureMode heightMode);
+    static const MeasureProvider kRecordedProvider;
+
+    void clear();
+
+    float availableWidth_ = 0.0f;
+    float availableHeight_ = 0.0f;
+    std::vector<Style> styles_;
+    std::vector<RecordedNode> nodes_;       // Pre-order
+    std::vector<Measurement> measurements_; // By node, in node order
+
+    // Instantiated tree; destroyed before the data its leaves point at
+    std::vector<RecordedLeaf> leaves_;
+    std::vector<std::unique_ptr<LayoutNode>> tree_;
+};
+
+} // namespace obsidian::layout
@@ -0,0 +1,168 @@
+/**
+ * Obsidian Layout Engine - Flat Layout Tree Implementation
+ */
+
+#include "layout_tree.h"
+#include <algorithm>
+
+namespace obsidian::layout {
+
+LayoutTree::~LayoutTree() {
+    releaseMeasures();
+}
+
+void LayoutTree::reserve(size_t nodeCount) {
+    styles_.reserve(nodeCount);
+    styleOffset_.reserve(nodeCount);
+    results_.reserve(nodeCount);
+    parent_.reserve(nodeCount);
+    firstChild_.reserve(nodeCount);
+    lastChild_.reserve(nodeCount);
+    nextSibling_.reserve(nodeCount);
+    prevSibling_.reserve(nodeCount);
+    childCount_.reserve(nodeCount);
+    measureIndex_.reserve(nodeCount);
+    nativeViews_.reserve(nodeCount);
+}
+
+void LayoutTree::clear() {
+    styles_.clear();
+    styleOffset_.clear();
+    styleValues_.clear();
+    staleStyleValues_ = 0;
+    results_.clear();
+    parent_.clear();
+    firstChild_.clear();
+    lastChild_.clear();
+    nextSibling_.clear();
+    prevSibling_.clear();
+    childCount_.clear();
+    measureIndex_.clear();
+    nativeViews_.clear();
+    releaseMeasures();
+}
+
+NodeId LayoutTree::createNode() {
+    return createNode(Style{});
+}
+
+NodeId LayoutTree::createNode(const Style& style) {
+    auto id = static_cast<NodeId>(styles_.size());
+    float values[kStylePropertyCount];
+    CompactStyle compact = CompactStyle::encode(style, values);
+    styles_.push_back(compact);
+    styleOffset_.push_back(static_cast<uint32_t>(styleValues_.size()));
+    styleValues_.insert(styleValues_.end(), values, values + compact.getValueCount());
+    results_.emplace_back();
+    parent_.push_back(kInvalidNodeId);
+    firstChild_.push_back(kInvalidNodeId);
+    lastChild_.push_back(kInvalidNodeId);
+    nextSibling_.push_back(kInvalidNodeId);
+    prevSibling_.push_back(kInvalidNodeId);
+    childCount_.push_back(0);
+    measureIndex_.push_back(kNoMeasureFunc);
+    nativeViews_.push_back(nullptr);
+    return id;
+}
+
+void LayoutTree::appendChild(NodeId parent, NodeId child) {
+    if (parent >= size() || child >= size() || parent == child) return;
+    if (parent_[child] != kInvalidNodeId) return;  // Already attached
+
+    NodeId last = lastChild_[parent];
+    if (last == kInvalidNodeId) {
+        firstChild_[parent] = child;
+    } else {
+        nextSibling_[last] = child;
+        prevSibling_[child] = last;
+    }
+    lastChild_[parent] = child;
+    parent_[child] = parent;
+    ++childCount_[parent];
+}
+
+void LayoutTree::setStyle(NodeId node, const Style& style) {
+    if (node >= size()) return;
+
+    float values[kStylePropertyCount];
+    CompactStyle compact = CompactStyle::encode(style, values);
+    size_t oldCount = styles_[node].getValueCount();
+    size_t newCount = compact.getValueCount();
+
+    // Rewrite in place when the values fit, otherwise move to the end
+    if (newCount > oldCount) {
+        staleStyleValues_ += oldCount;
+        styleOffset_[node] = static_cast<uint32_t>(styleValues_.size());
+        styleValues_.resize(styleValues_.size() + newCount);
+    } else {
+        staleStyleValues_ += oldCount - newCount;
+    }
+    std::copy(values, values + newCount, styleValues_.begin() + styleOffset_[node]);
+    styles_[node] = compact;
+
+    if (staleStyleValues_ > styleValues_.size() / 2) {
+        compactStyleValues();
+    }
+}
+
+void LayoutTree::compactStyleValues() {
+    std::vector<float> values;
+    values.reserve(styleValues_.size() - staleStyleValues_);
+
+    for (size_t node = 0; node < styles_.size(); ++node) {
+        auto begin = styleValues_.begin() + styleOffset_[node];
+        styleOffset_[node] = static_cast<uint32_t>(values.size());
+        values.insert(values.end(), begin, begin + styles_[node].getValueCount());
+    }
+
+    styleValues_ = std::move(values);
+    staleStyleValues_ = 0;
+}
+
+void LayoutTree::setMeasureFunc(NodeId node, MeasureFunc func) {
+    if (!func) {
+        setMeasureProvider(node, nullptr, nullptr);
+        return;
+    }
+    if (node >= size()) return;
+    setMeasureProvider(node, &kMeasureFuncProvider, new MeasureFunc(std::move(func)));
+}
+
+void LayoutTree::setMeasureProvider(NodeId node, const MeasureProvider* provider, void* context) {
+    if (node >= size()) return;
+
+    if (measureIndex_[node] == kNoMeasureFunc) {
+        if (!provider) return;
+        measureIndex_[node] = static_cast<uint32_t>(measures_.size());
+        measures_.emplace_back();
+    }
+
+    MeasureBinding& binding = measures_[measureIndex_[node]];
+    if (binding.provider && binding.provider->release) {
+        binding.provider->release(binding.context);
+    }
+    binding.provider = provider;
+    binding.context = provider ? context : nullptr;
+}
+
+void LayoutTree::releaseMeasures() {
+    for (const MeasureBinding& binding : measures_) {
+        if (binding.provider && binding.provider->release) {
+            binding.provider->release(binding.context);
+        }
+    }
+    measures_.clear();
+}
+
+Size LayoutTree::measure(NodeId node, float width, MeasureMode widthMode,
+                         float height, MeasureMode heightMode) {
+    if (hasMeasureFunc(node)) {
+        const MeasureBinding& binding = measures_[measureIndex_[node]];
+        return binding.provider->measure(binding.context, width, widthMode, height, heightMode);
+    }
+
+    // Default: return 0x0 for nodes without measure function
+    return {0.0f, 0.0f};
+}
+
+} // namespace obsidian::layout
@@ -0,0 +1,138 @@
+/**
+ * Obsidian Layout Engine - Flat Layout Tree
+ *
+ * Alternative storage for very large layout trees. Instead of one heap
+ * object per node, nodes live in contiguous arrays (struct-of-arrays)
+ * and are addressed by a 32-bit index:
+ * - Styles (input), compactly encoded: see CompactStyle
+ * - Computed layout results (output)
+ * - Parent / first-child / next-sibling links
+ *
+ * Nodes created in document order are traversed linearly by the engine,
+ * which keeps layout of 100k+ node trees free of pointer chasing.
+ */
+
+#pragma once
+
+#include "node.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace obsidian::layout {
+
+/**
+ * Index of a node in a LayoutTree
+ */
+using NodeId = uint32_t;
+
+constexpr NodeId kInvalidNodeId = std::numeric_limits<NodeId>::max();
+
+/**
+ * Layout Tree
+ *
+ * Owns all of its nodes. Nodes are never freed individually;
+ * call clear() to drop the whole tree.
+ */
+class LayoutTree {
+public:
+    LayoutTree() = default;
+    ~LayoutTree();
+
+    LayoutTree(const LayoutTree&) = delete;
+    LayoutTree& operator=(const LayoutTree&) = delete;
+
+    /**
+     * Reserve storage for a number of nodes
+     */
+    void reserve(size_t nodeCount);
+
+    /**
+     * Remove all nodes
+     */
+    void clear();
+
+    /**
+     * Create a detached node and return its index
+     */
+    NodeId createNode();
+    NodeId createNode(const Style& style);
+
+    // Children
+    void appendChild(NodeId parent, NodeId child);
+
+    size_t size() const { return styles_.size(); }
+    uint32_t getChildCount(NodeId node) const { return childCount_[node]; }
+
+    // Links (kInvalidNodeId when absent)
+    NodeId getParent(NodeId node) const { return parent_[node]; }
+    NodeId getFirstChild(NodeId node) const { return firstChild_[node]; }
+    NodeId getLastChild(NodeId node) const { return lastChild_[node]; }
+    NodeId getNextSibling(NodeId node) const { return nextSibling_[node]; }
+    NodeId getPrevSibling(NodeId node) const { return prevSibling_[node]; }
+
+    // Style (decoded copy; write back with setStyle)
+    Style getStyle(NodeId node) const {
+        return styles_[node].decode(styleValues_.data() + styleOffset_[node]);
+    }
+    void setStyle(NodeId node, const Style& style);
+    const CompactStyle& getCompactStyle(NodeId node) const { return styles_[node]; }
+    // Values the compact style was encoded with, for its accessors
+    const float* getStyleValues(NodeId node) const { return styleValues_.data() + styleOffset_[node]; }
+
+    // Layout results (read-only from outside)
+    const LayoutResult& getLayout(NodeId node) const { return results_[node]; }
+
+    // Measure function or provider (for leaf nodes like text)
+    void setMeasureFunc(NodeId node, MeasureFunc func);
+    void setMeasureProvider(NodeId node, const MeasureProvider* provider, void* context);
+    bool hasMeasureFunc(NodeId node) const {
+        return measureIndex_[node] != kNoMeasureFunc && measures_[measureIndex_[node]].provider;
+    }
+
+    // Native view association (for applying layout)
+    void setNativeView(NodeId node, void* view) { nativeViews_[node] = view; }
+    void* getNativeView(NodeId node) const { return nativeViews_[node]; }
+
+private:
+    friend class LayoutEngine;
+
+    static constexpr uint32_t kNoMeasureFunc = std::numeric_limits<uint32_t>::max();
+
+    struct MeasureBinding {
+        const MeasureProvider* provider = nullptr;
+        void* context = nullptr;
+    };
+
+    void releaseMeasures();
+
+    Size measure(NodeId node, float width, MeasureMode widthMode,
+                 float height, MeasureMode heightMode);
+
+    LayoutResult& getMutableLayout(NodeId node) { return results_[node]; }
+
+    void compactStyleValues();
+
+    // Per-node arrays, all indexed by NodeId
+    std::vector<CompactStyle> styles_;
+    std::vector<uint32_t> styleOffset_;  // First value in styleValues_
+    std::vector<LayoutResult> results_;
+    std::vector<NodeId> parent_;
+    std::vector<NodeId> firstChild_;
+    std::vector<NodeId> lastChild_;
+    std::vector<NodeId> nextSibling_;
+    std::vector<NodeId> prevSibling_;
+    std::vector<uint32_t> childCount_;
+    std::vector<uint32_t> measureIndex_;
+    std::vector<void*> nativeViews_;
+
+    // Set style values of all nodes; restyled nodes that outgrow their
+    // run move to the end and leave stale values behind
+    std::vector<float> styleValues_;
+    size_t staleStyleValues_ = 0;
+
+    // Measure providers are sparse; only leaves have one
+    std::vector<MeasureBinding> measures_;
+};
+
+} // namespace obsidian::layout
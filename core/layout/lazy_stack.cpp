@@ -0,0 +1,200 @@
+/**
+ * Obsidian Layout Engine - Lazy Stack Implementation
+ */
+
+#include "lazy_stack.h"
+#include <algorithm>
+#include <utility>
+
+namespace obsidian::layout {
+
+LazyStack::LazyStack(FlexDirection direction) {
+    getStyle().flexDirection = direction;
+    addChild(&leadingSpacer_);
+    addChild(&trailingSpacer_);
+    setSpacerExtent(leadingSpacer_, 0.0f);
+    setSpacerExtent(trailingSpacer_, 0.0f);
+}
+
+LazyStack::~LazyStack() {
+    releaseAll();
+    removeAllChildren();
+}
+
+bool LazyStack::isColumn() const {
+    FlexDirection direction = std::as_const(*this).getStyle().flexDirection;
+    return direction == FlexDirection::Column || direction == FlexDirection::ColumnReverse;
+}
+
+void LazyStack::setItemFactory(ItemFactory factory, ItemRecycler recycler) {
+    releaseAll();
+    factory_ = std::move(factory);
+    recycler_ = std::move(recycler);
+}
+
+void LazyStack::setExtentEstimator(ExtentEstimator estimator) {
+    estimator_ = std::move(estimator);
+    setItemCount(extents_.size());
+}
+
+void LazyStack::setItemCount(size_t count) {
+    releaseAll();
+
+    extents_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        extents_[i] = estimator_ ? estimator_(i) : kDefaultItemExtent;
+    }
+    rebuildOffsetTree();
+
+    setSpacerExtent(leadingSpacer_, 0.0f);
+    setSpacerExtent(trailingSpacer_, getContentExtent());
+}
+
+void LazyStack::setViewport(float offset, float length) {
+    viewportOffset_ = offset;
+    viewportLength_ = std::max(0.0f, length);
+}
+
+LayoutNode* LazyStack::getItemNode(size_t index) const {
+    if (index < first_ || index - first_ >= items_.size()) return nullptr;
+    return items_[index - first_];
+}
+
+void LazyStack::updateVisibleRange() {
+    recordMeasuredExtents();
+
+    size_t count = extents_.size();
+    size_t begin = 0;
+    size_t end = 0;
+    if (count > 0 && factory_) {
+        float start = std::max(0.0f, viewportOffset_ - overscan_);
+        float stop = viewportOffset_ + viewportLength_ + overscan_;
+        begin = findItemAt(start);
+        end = std::min(count, findItemAt(stop) + 1);
+    }
+
+    // Release items that left the range
+    size_t oldEnd = first_ + items_.size();
+    if (begin >= oldEnd || end <= first_) {
+        releaseAll();
+        first_ = begin;
+    } else {
+        while (first_ < begin) releaseFront();
+        while (first_ + items_.size() > end) releaseBack();
+    }
+
+    // Materialize the new ones; children are [leading, items..., trailing]
+    while (first_ > begin) {
+        LayoutNode* node = factory_(first_ - 1);
+        items_.push_front(node);
+        --first_;
+        if (node) insertChild(node, 1);
+    }
+    while (first_ + items_.size() < end) {
+        LayoutNode* node = factory_(first_ + items_.size());
+        items_.push_back(node);
+        if (node) insertChild(node, getChildCount() - 1);
+    }
+
+    setSpacerExtent(leadingSpacer_, prefixExtent(first_));
+    setSpacerExtent(trailingSpacer_, getContentExtent() - prefixExtent(first_ + items_.size()));
+}
+
+void LazyStack::recordMeasuredExtents() {
+    bool column = isColumn();
+    for (size_t i = 0; i < items_.size(); ++i) {
+        LayoutNode* node = items_[i];
+        if (!node || node->isDirty()) continue;  // Not laid out yet
+
+        const LayoutResult& layout = node->getLayout();
+        setExtent(first_ + i, column ? layout.height : layout.width);
+    }
+}
+
+void LazyStack::releaseFront() {
+    LayoutNode* node = items_.front();
+    items_.pop_front();
+    if (node) {
+        removeChild(node);
+        if (recycler_) {
+            recycler_(first_, node);
+        } else {
+            delete node;
+        }
+    }
+    ++first_;
+}
+
+void LazyStack::releaseBack() {
+    LayoutNode* node = items_.back();
+    items_.pop_back();
+    if (node) {
+        removeChild(node);
+        if (recycler_) {
+            recycler_(first_ + items_.size(), node);
+        } else {
+            delete node;
+        }
+    }
+}
+
+void LazyStack::releaseAll() {
+    while (!items_.empty()) releaseBack();
+    first_ = 0;
+}
+
+void LazyStack::setSpacerExtent(LayoutNode& spacer, float extent) {
+    // Copy through the const getter; the non-const one unshares the style first
+    Style style = std::as_const(spacer).getStyle();
+    LayoutValue& size = isColumn() ? style.height : style.width;
+    size = LayoutValue::points(std::max(0.0f, extent));
+    spacer.setStyle(style);
+}
+
+void LazyStack::rebuildOffsetTree() {
+    size_t count = extents_.size();
+    offsetTree_.assign(count + 1, 0.0f);
+    for (size_t i = 1; i <= count; ++i) {
+        offsetTree_[i] += extents_[i - 1];
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= count) {
+            offsetTree_[parent] += offsetTree_[i];
+        }
+    }
+}
+
+void LazyStack::setExtent(size_t index, float extent) {
+    float delta = extent - extents_[index];
+    if (delta == 0.0f) return;
+
+    extents_[index] = extent;
+    for (size_t i = index + 1; i < offsetTree_.size(); i += i & (~i + 1)) {
+        offsetTree_[i] += delta;
+    }
+}
+
+float LazyStack::prefixExtent(size_t count) const {
+    float sum = 0.0f;
+    for (size_t i = std::min(count, extents_.size()); i > 0; i -= i & (~i + 1)) {
+        sum += offsetTree_[i];
+    }
+    return sum;
+}
+
+size_t LazyStack::findItemAt(float offset) const {
+    // Count the items that end at or before offset
+    size_t count = extents_.size();
+    size_t step = 1;
+    while (step * 2 <= count) step *= 2;
+
+    size_t position = 0;
+    for (; step > 0; step /= 2) {
+        if (position + step <= count && offsetTree_[position + step] <= offset) {
+            position += step;
+            offset -= offsetTree_[position];
+        }
+    }
+    return std::min(position, count > 0 ? count - 1 : 0);
+}
+
+} // namespace obsidian::layout
@@ -0,0 +1,140 @@
+/**
+ * Obsidian Layout Engine - Lazy Stack
+ *
+ * A stack whose items are materialized on demand. Instead of one
+ * LayoutNode (and native view) per item, it keeps one extent per item,
+ * estimated until the item has been laid out once. It creates nodes
+ * only for the items that intersect the viewport plus an overscan
+ * margin.
+ *
+ * Two spacer children stand in for the items before and after the
+ * materialized range, so the engine lays a LazyStack out like any other
+ * container. Its main size is the estimated size of the whole list.
+ * Layout time does not depend on the total item count.
+ */
+
+#pragma once
+
+#include "node.h"
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace obsidian::layout {
+
+/**
+ * LazyStack
+ *
+ * Children are managed by the stack; don't add or remove them directly.
+ * Item spacing must be part of the item extents, since a gap would also
+ * apply around the spacers.
+ */
+class LazyStack : public LayoutNode {
+public:
+    // Extent used for items when no estimator is set
+    static constexpr float kDefaultItemExtent = 44.0f;
+
+    /**
+     * Create the node for an item (owned by the stack until recycled)
+     */
+    using ItemFactory = std::function<LayoutNode*(size_t index)>;
+
+    /**
+     * Take back the node of an item that left the materialized range
+     */
+    using ItemRecycler = std::function<void(size_t index, LayoutNode* node)>;
+
+    /**
+     * Estimated main-axis extent of an item that wasn't laid out yet
+     */
+    using ExtentEstimator = std::function<float(size_t index)>;
+
+    explicit LazyStack(FlexDirection direction = FlexDirection::Column);
+    ~LazyStack();
+
+    /**
+     * Set how item nodes are created and released
+     * Without a recycler, released nodes are deleted.
+     */
+    void setItemFactory(ItemFactory factory, ItemRecycler recycler = nullptr);
+    void setExtentEstimator(ExtentEstimator estimator);
+
+    /**
+     * Set the number of items
+     * Releases all materialized items and re-estimates every extent.
+     */
+    void setItemCount(size_t count);
+    size_t getItemCount() const { return extents_.size(); }
+
+    /**
+     * Visible part of the stack along its main axis, in stack coordinates
+     * (typically the scroll offset and the scroll view's size)
+     */
+    void setViewport(float offset, float length);
+
+    /**
+     * Extra distance materialized before and after the viewport
+     */
+    void setOverscan(float overscan) { overscan_ = overscan; }
+
+    /**
+     * Materialize the items in the viewport and release the others
+     *
+     * Call before each layout pass (e.g. on scroll). Items laid out by the
+     * previous pass first replace their estimated extent with the measured
+     * one. Marks the stack dirty only when something changed.
+     */
+    void updateVisibleRange();
+
+    // Materialized range
+    size_t getFirstMaterializedIndex() const { return first_; }
+    size_t getMaterializedCount() const { return items_.size(); }
+
+    /**
+     * Node of a materialized item, nullptr otherwise
+     */
+    LayoutNode* getItemNode(size_t index) const;
+
+    // Offsets and extents along the main axis (estimates where unmeasured)
+    float getItemOffset(size_t index) const { return prefixExtent(index); }
+    float getItemExtent(size_t index) const { return extents_[index]; }
+    float getContentExtent() const { return prefixExtent(extents_.size()); }
+
+private:
+    bool isColumn() const;
+
+    // Extents are summed with a Fenwick tree, so offsets and the item at
+    // an offset take O(log n) and a measured extent updates in O(log n)
+    void rebuildOffsetTree();
+    void setExtent(size_t index, float extent);
+    float prefixExtent(size_t count) const;
+    size_t findItemAt(float offset) const;
+
+    void recordMeasuredExtents();
+    void releaseFront();
+    void releaseBack();
+    void releaseAll();
+    void setSpacerExtent(LayoutNode& spacer, float extent);
+
+    ItemFactory factory_;
+    ItemRecycler recycler_;
+    ExtentEstimator estimator_;
+
+    std::vector<float> extents_;
+    std::vector<float> offsetTree_;  // Fenwick tree over extents_, 1-based
+
+    float viewportOffset_ = 0.0f;
+    float viewportLength_ = 0.0f;
+    float overscan_ = 0.0f;
+
+    // Materialized items [first_, first_ + items_.size())
+    size_t first_ = 0;
+    std::deque<LayoutNode*> items_;
+
+    // Stand-ins for the items before and after the materialized range
+    LayoutNode leadingSpacer_;
+    LayoutNode trailingSpacer_;
+};
+
+} // namespace obsidian::layout
@@ -15,9 +15,15 @@ void LayoutManager::setNativeSetFrameFunc(NativeSetFrameFunc func) {
     setFrameFunc_ = func;
 }
 
+void LayoutManager::setNativeApplyFramesFunc(NativeApplyFramesFunc func) {
+    applyFramesFunc_ = func;
+}
+
 void LayoutManager::calculateAndApply(LayoutNode* root, float width, float height) {
     if (!root) return;
     
+    jobs_.erase(root);
+    
     // Calculate layout
     LayoutEngine::calculateLayout(root, width, height);
     
@@ -26,30 +32,116 @@ void LayoutManager::calculateAndApply(LayoutNode* root, float width, float heigh
 }
 
 void LayoutManager::applyToNativeViews(LayoutNode* root) {
-    if (!root || !setFrameFunc_) return;
+    if (!root || (!setFrameFunc_ && !applyFramesFunc_)) return;
     
-    // Apply starting from root (position is relative to parent)
-    applyRecursive(root, 0.0f, 0.0f);
+    // Positions are relative to the parent; only changed frames are set
+    frameBuffer_.collectChanges(root);
+    if (applyFramesFunc_) {
+        frameBuffer_.apply(applyFramesFunc_);
+    } else {
+        frameBuffer_.apply(setFrameFunc_);
+    }
 }
 
-void LayoutManager::applyRecursive(LayoutNode* node, float parentAbsX, float parentAbsY) {
-    const LayoutResult& layout = node->getLayout();
+void LayoutManager::setVisibleRect(LayoutNode* container, const Rect& visible, float margin) {
+    if (!container) return;
+    
+    frameBuffer_.setVisibleRect(container, visible, margin);
     
-    // Apply frame to native view if it exists
-    if (node->getNativeView() && setFrameFunc_) {
-        setFrameFunc_(node->getNativeView(), 
-                      layout.left, layout.top,
-                      layout.width, layout.height);
+    // Only content that came into view has frames left to apply
+    applyToNativeViews(container);
+}
+
+void LayoutManager::clearVisibleRect(LayoutNode* container) {
+    frameBuffer_.clearVisibleRect(container);
+}
+
+void LayoutManager::invalidateFrames(LayoutNode* root) {
+    FrameBuffer::invalidate(root);
+}
+
+LayoutManager::ResizeState& LayoutManager::getResizeState(LayoutNode* root) {
+    auto& state = resizeStates_[root];
+    if (!state) {
+        state = std::make_unique<ResizeState>();
     }
+    return *state;
+}
+
+void LayoutManager::resize(LayoutNode* root, float width, float height) {
+    if (!root) return;
     
-    // Calculate absolute position for children
-    float absX = parentAbsX + layout.left;
-    float absY = parentAbsY + layout.top;
+    jobs_.erase(root);
     
-    // Recurse to children
-    for (auto* child : node->getChildren()) {
-        applyRecursive(child, absX, absY);
+    ResizeState& state = getResizeState(root);
+    state.width = width;
+    state.height = height;
+    state.pending = true;
+    
+    // Coalesced until the next frame during a live resize
+    if (!state.liveResize) {
+        layoutPending(root, state);
     }
 }
 
+void LayoutManager::beginLiveResize(LayoutNode* root) {
+    if (!root) return;
+    
+    getResizeState(root).liveResize = true;
+}
+
+void LayoutManager::endLiveResize(LayoutNode* root) {
+    auto it = resizeStates_.find(root);
+    if (it == resizeStates_.end()) return;
+    
+    ResizeState& state = *it->second;
+    state.liveResize = false;
+    layoutPending(root, state);
+}
+
+void LayoutManager::calculateAndApplyInSlices(LayoutNode* root, float width, float height) {
+    if (!root) return;
+    
+    jobs_[root] = std::make_unique<LayoutJob>(root, width, height);
+}
+
+bool LayoutManager::hasPendingSlices(LayoutNode* root) const {
+    return jobs_.count(root) > 0;
+}
+
+void LayoutManager::setSliceBudget(std::chrono::microseconds budget) {
+    sliceBudget_ = budget;
+}
+
+void LayoutManager::onFrame() {
+    for (auto& [root, state] : resizeStates_) {
+        if (state->liveResize) {
+            layoutPending(root, *state);
+        }
+    }
+    
+    for (auto it = jobs_.begin(); it != jobs_.end();) {
+        if (it->second->runSlice(sliceBudget_)) {
+            // Frames are only consistent now; apply them together
+            applyToNativeViews(it->first);
+            it = jobs_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void LayoutManager::releaseRoot(LayoutNode* root) {
+    resizeStates_.erase(root);
+    jobs_.erase(root);
+}
+
+void LayoutManager::layoutPending(LayoutNode* root, ResizeState& state) {
+    if (!state.pending) return;
+    
+    state.pending = false;
+    state.cache.calculateLayout(root, state.width, state.height);
+    applyToNativeViews(root);
+}
+
 } // namespace obsidian::layout
@@ -10,6 +10,8 @@
 
 #include "node.h"
 #include "engine.h"
+#include "resize_cache.h"
+#include <chrono>
 #include <memory>
 #include <unordered_map>
 
@@ -23,6 +25,13 @@ using NativeSetFrameFunc = void(*)(void* nativeView,
                                     float x, float y, 
                                     float width, float height);
 
+/**
+ * Platform-specific batched frame setter (optional)
+ * Sets the frames of many views in one call, e.g. inside a single
+ * transaction.
+ */
+using NativeApplyFramesFunc = ApplyFramesFunc;
+
 /**
  * LayoutManager - Manages layout calculation and application
  * 
@@ -30,6 +39,16 @@ using NativeSetFrameFunc = void(*)(void* nativeView,
  * 1. Create LayoutNodes and build tree
  * 2. Associate native views with nodes
  * 3. Call calculateAndApply() on root
+ * 
+ * For window roots, call resize() on every size change instead. Recent
+ * sizes are served from a per-root ResizeLayoutCache, and during a live
+ * resize the layout passes are coalesced to one per display frame.
+ * 
+ * Only views whose frame changed since it was last applied are set,
+ * in one batched call when a NativeApplyFramesFunc is set.
+ * 
+ * Trees too large to lay out within a frame can be laid out in slices
+ * with calculateAndApplyInSlices(), also driven by onFrame().
  */
 class LayoutManager {
 public:
@@ -44,6 +63,13 @@ public:
      */
     void setNativeSetFrameFunc(NativeSetFrameFunc func);
     
+    /**
+     * Set the platform-specific batched frame setter
+     * When set, the changed frames of a pass go to it in one call
+     * instead of one NativeSetFrameFunc call per view.
+     */
+    void setNativeApplyFramesFunc(NativeApplyFramesFunc func);
+    
     /**
      * Calculate layout for a node tree and apply to native views
      * 
@@ -58,6 +84,68 @@ public:
      */
     void applyToNativeViews(LayoutNode* root);
     
+    /**
+     * Lay out a window root at a new size and apply it
+     * Outside a live resize this happens right away; during one, only
+     * the latest size is laid out, on the next onFrame().
+     */
+    void resize(LayoutNode* root, float width, float height);
+    
+    /**
+     * Bracket a live (interactive) window resize
+     * Ending it lays out the final size right away.
+     */
+    void beginLiveResize(LayoutNode* root);
+    void endLiveResize(LayoutNode* root);
+    
+    /**
+     * Lay out a root in time slices, one per onFrame(), and apply its
+     * frames once the layout is complete, all in one go
+     * Replaces a sliced layout still pending for the root; changes to
+     * the tree in between slices start it over. calculateAndApply() and
+     * resize() of the root cancel it.
+     */
+    void calculateAndApplyInSlices(LayoutNode* root, float width, float height);
+    bool hasPendingSlices(LayoutNode* root) const;
+    
+    /**
+     * Time each sliced layout may take per frame (default 4ms)
+     */
+    void setSliceBudget(std::chrono::microseconds budget);
+    
+    /**
+     * Run the pending layout of every root in live resize, and a slice of
+     * every sliced layout
+     * Call once per display frame, e.g. from the display link.
+     */
+    void onFrame();
+    
+    /**
+     * Set the visible part of a scroll container's content
+     * Frames outside it plus `margin` are deferred until they scroll into
+     * view (see FrameBuffer::setVisibleRect). Call it on every scroll:
+     * it applies the frames that came into view right away.
+     */
+    void setVisibleRect(LayoutNode* container, const Rect& visible, float margin = 0.0f);
+    
+    /**
+     * Stop culling a scroll container's content, e.g. before destroying it
+     * Deferred frames are applied with the next pass.
+     */
+    void clearVisibleRect(LayoutNode* container);
+    
+    /**
+     * Set every frame of a root on its next apply, e.g. after its native
+     * views were recreated or moved by other code
+     */
+    void invalidateFrames(LayoutNode* root);
+    
+    /**
+     * Forget the resize state and sliced layout of a root that is being
+     * destroyed
+     */
+    void releaseRoot(LayoutNode* root);
+    
 private:
     LayoutManager() = default;
     ~LayoutManager() = default;
@@ -67,9 +155,28 @@ private:
     LayoutManager& operator=(const LayoutManager&) = delete;
     
     NativeSetFrameFunc setFrameFunc_ = nullptr;
+    NativeApplyFramesFunc applyFramesFunc_ = nullptr;
+    
+    // Changed frames of the current apply
+    FrameBuffer frameBuffer_;
+    
+    // Resize state of a window root
+    struct ResizeState {
+        ResizeLayoutCache cache;
+        bool liveResize = false;
+        bool pending = false;
+        float width = 0.0f;
+        float height = 0.0f;
+    };
+    
+    std::unordered_map<LayoutNode*, std::unique_ptr<ResizeState>> resizeStates_;
+    
+    ResizeState& getResizeState(LayoutNode* root);
+    void layoutPending(LayoutNode* root, ResizeState& state);
     
-    // Internal recursive apply
-    void applyRecursive(LayoutNode* node, float parentAbsX, float parentAbsY);
+    // Sliced layouts in progress
+    std::unordered_map<LayoutNode*, std::unique_ptr<LayoutJob>> jobs_;
+    std::chrono::microseconds sliceBudget_{4000};
 };
 
 } // namespace obsidian::layout
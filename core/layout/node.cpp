@@ -5,15 +5,86 @@
 #include "node.h"
 #include "engine.h"
 #include <algorithm>
+#include <cstdio>
+#include <utility>
 
 namespace obsidian::layout {
 
+const MeasureProvider kMeasureFuncProvider{
+    [](void* context, float width, MeasureMode widthMode, float height, MeasureMode heightMode) {
+        return (*static_cast<MeasureFunc*>(context))(width, widthMode, height, heightMode);
+    },
+    nullptr,
+    [](void* context) { delete static_cast<MeasureFunc*>(context); }
+};
+
+const Size* LayoutCache::findMeasurement(const LayoutConstraints& constraints) const {
+    for (uint8_t i = 0; i < measurementCount; ++i) {
+        if (measurements[i].constraints == constraints) {
+            return &measurements[i].size;
+        }
+    }
+    return nullptr;
+}
+
+void LayoutCache::addMeasurement(const LayoutConstraints& constraints, Size size) {
+    measurements[nextMeasurement] = {constraints, size};
+    nextMeasurement = static_cast<uint8_t>((nextMeasurement + 1) % kMaxMeasurements);
+    if (measurementCount < kMaxMeasurements) {
+        ++measurementCount;
+    }
+}
+
+void LayoutCache::clear() {
+    hasLayout = false;
+    measurementCount = 0;
+    nextMeasurement = 0;
+}
+
 LayoutNode::LayoutNode() = default;
 LayoutNode::~LayoutNode() {
     // Don't delete children - we don't own them
+    for (auto* child : children_) {
+        child->parent_ = nullptr;
+    }
     if (parent_) {
         parent_->removeChild(this);
     }
+    if (measureProvider_ && measureProvider_->release) {
+        measureProvider_->release(measureContext_);
+    }
+}
+
+Style& LayoutNode::getStyle() {
+    // Copy on write: interned instances are shared and never modified
+    if (styleInterned_) {
+        style_ = std::make_shared<Style>(*style_);
+        styleInterned_ = false;
+    }
+    return const_cast<Style&>(*style_);
+}
+
+void LayoutNode::setStyle(const Style& style) {
+    SharedStyle shared = StyleInterner::intern(style);
+    internStyle();
+    if (shared == style_) return;
+    
+    style_ = std::move(shared);
+    markDirty(DirtyReason::StyleChanged);
+}
+
+bool LayoutNode::hasSameStyle(const LayoutNode& other) const {
+    if (styleInterned_ && other.styleInterned_) {
+        return style_ == other.style_;
+    }
+    return *style_ == *other.style_;
+}
+
+void LayoutNode::internStyle() {
+    if (styleInterned_) return;
+    
+    style_ = StyleInterner::intern(*style_);
+    styleInterned_ = true;
 }
 
 void LayoutNode::addChild(LayoutNode* child) {
@@ -24,9 +95,11 @@ void LayoutNode::addChild(LayoutNode* child) {
         child->parent_->removeChild(child);
     }
     
+    child->indexInParent_ = children_.size();
     children_.push_back(child);
     child->parent_ = this;
-    markDirty();
+    child->internStyle();
+    markDirty(DirtyReason::ChildrenChanged);
 }
 
 void LayoutNode::insertChild(LayoutNode* child, size_t index) {
@@ -40,18 +113,20 @@ void LayoutNode::insertChild(LayoutNode* child, size_t index) {
     index = std::min(index, children_.size());
     children_.insert(children_.begin() + index, child);
     child->parent_ = this;
-    markDirty();
+    child->internStyle();
+    reindexChildren(index);
+    markDirty(DirtyReason::ChildrenChanged);
 }
 
 void LayoutNode::removeChild(LayoutNode* child) {
-    if (!child) return;
+    if (!child || child->parent_ != this) return;
     
-    auto it = std::find(children_.begin(), children_.end(), child);
-    if (it != children_.end()) {
-        children_.erase(it);
-        child->parent_ = nullptr;
-        markDirty();
-    }
+    // The child knows where it is; only later siblings move
+    size_t index = child->indexInParent_;
+    children_.erase(children_.begin() + index);
+    child->parent_ = nullptr;
+    reindexChildren(index);
+    markDirty(DirtyReason::ChildrenChanged);
 }
 
 void LayoutNode::removeAllChildren() {
@@ -59,7 +134,79 @@ void LayoutNode::removeAllChildren() {
         child->parent_ = nullptr;
     }
     children_.clear();
-    markDirty();
+    markDirty(DirtyReason::ChildrenChanged);
+}
+
+void LayoutNode::setChildren(std::span<LayoutNode* const> children) {
+    replaceChildren(0, children_.size(), children);
+}
+
+void LayoutNode::replaceChildren(size_t first, size_t count, std::span<LayoutNode* const> children) {
+    first = std::min(first, children_.size());
+    count = std::min(count, children_.size() - first);
+    
+    // Detach the replaced range, and claim the incoming children: those
+    // already here leave their old slot, others leave their old parent
+    for (size_t i = first; i < first + count; ++i) {
+        children_[i]->parent_ = nullptr;
+    }
+    for (auto* child : children) {
+        if (!child) continue;
+        if (child->parent_ == this) {
+            child->parent_ = nullptr;
+        } else if (child->parent_) {
+            child->parent_->removeChild(child);
+        }
+    }
+    
+    // Kept children are those still attached
+    std::vector<LayoutNode*> result;
+    result.reserve(children_.size() - count + children.size());
+    auto keep = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (children_[i]->parent_ == this) result.push_back(children_[i]);
+        }
+    };
+    keep(0, first);
+    size_t insertAt = result.size();
+    keep(first + count, children_.size());
+    size_t keptCount = result.size();
+    for (auto* child : children) {
+        if (!child || child->parent_ == this) continue;  // Listed twice
+        child->parent_ = this;
+        child->internStyle();
+        result.push_back(child);
+    }
+    std::rotate(result.begin() + insertAt, result.begin() + keptCount, result.end());
+    
+    children_ = std::move(result);
+    reindexChildren(0);
+    markDirty(DirtyReason::ChildrenChanged);
+}
+
+void LayoutNode::reindexChildren(size_t from) {
+    for (size_t i = from; i < children_.size(); ++i) {
+        children_[i]->indexInParent_ = i;
+    }
+}
+
+LayoutNode* LayoutNode::nextInPreOrder(const LayoutNode* root, bool descend) {
+    return const_cast<LayoutNode*>(std::as_const(*this).nextInPreOrder(root, descend));
+}
+
+const LayoutNode* LayoutNode::nextInPreOrder(const LayoutNode* root, bool descend) const {
+    if (descend && !children_.empty()) {
+        return children_.front();
+    }
+    
+    // Next sibling of the nearest ancestor (up to root) that has one
+    for (const LayoutNode* node = this; node != root && node->parent_; node = node->parent_) {
+        const std::vector<LayoutNode*>& siblings = node->parent_->children_;
+        if (node->indexInParent_ + 1 < siblings.size()) {
+            return siblings[node->indexInParent_ + 1];
+        }
+    }
+    return nullptr;
 }
 
 LayoutNode* LayoutNode::getChild(size_t index) const {
@@ -68,16 +215,133 @@ LayoutNode* LayoutNode::getChild(size_t index) const {
 }
 
 void LayoutNode::setMeasureFunc(MeasureFunc func) {
-    measureFunc_ = std::move(func);
-    markDirty();
+    if (!func) {
+        setMeasureProvider(nullptr, nullptr);
+        return;
+    }
+    setMeasureProvider(&kMeasureFuncProvider, new MeasureFunc(std::move(func)));
 }
 
-void LayoutNode::markDirty() {
-    isDirty_ = true;
-    // Propagate to parent
-    if (parent_) {
-        parent_->markDirty();
+void LayoutNode::setMeasureProvider(const MeasureProvider* provider, void* context) {
+    if (measureProvider_ && measureProvider_->release) {
+        measureProvider_->release(measureContext_);
+    }
+    measureProvider_ = provider;
+    measureContext_ = provider ? context : nullptr;
+    markDirty(DirtyReason::MeasureChanged);
+}
+
+void LayoutNode::markDirty([[maybe_unused]] DirtyReason reason) {
+    // Propagate up until the root, or a boundary that absorbs it
+    LayoutNode* node = this;
+    while (true) {
+        node->internStyle();
+        node->isDirty_ = true;
+        node->cache_.clear();
+        
+        LayoutNode* parent = node->parent_;
+        if (!parent) {
+            ++node->dirtyGeneration_;
+#ifdef OBSIDIAN_LAYOUT_INVALIDATIONS
+            recordInvalidation(node, reason);
+#endif
+            return;
+        }
+        if (parent->absorbsDirtyChild()) {
+            // Its cache is kept to lay it out again with the same
+            // constraints; ancestors only record where to find it
+            parent->isDirty_ = true;
+            parent->flagAncestorsForRelayout();
+#ifdef OBSIDIAN_LAYOUT_INVALIDATIONS
+            recordInvalidation(parent, reason);
+#endif
+            return;
+        }
+        node = parent;
+    }
+}
+
+#ifdef OBSIDIAN_LAYOUT_INVALIDATIONS
+void LayoutNode::recordInvalidation(const LayoutNode* root, DirtyReason reason) {
+    LayoutNode* treeRoot = this;
+    while (treeRoot->parent_) {
+        treeRoot = treeRoot->parent_;
+    }
+    
+    // Repeats of the same invalidation are counted, not listed again
+    for (Invalidation& invalidation : treeRoot->invalidations_) {
+        if (invalidation.root == root && invalidation.origin == this &&
+            invalidation.reason == reason) {
+            ++invalidation.count;
+            return;
+        }
     }
+    treeRoot->invalidations_.push_back({root, this, reason, 1});
+}
+#endif
+
+void LayoutNode::takeInvalidations(std::vector<Invalidation>& out) {
+    out.clear();
+#ifdef OBSIDIAN_LAYOUT_INVALIDATIONS
+    LayoutNode* treeRoot = this;
+    while (treeRoot->parent_) {
+        treeRoot = treeRoot->parent_;
+    }
+    out.swap(treeRoot->invalidations_);
+#endif
+}
+
+const char* dirtyReasonName(DirtyReason reason) {
+    switch (reason) {
+        case DirtyReason::Explicit: return "explicit";
+        case DirtyReason::StyleChanged: return "style changed";
+        case DirtyReason::ChildrenChanged: return "children changed";
+        case DirtyReason::MeasureChanged: return "measure changed";
+        case DirtyReason::Relayout: return "relayout";
+    }
+    return "unknown";
+}
+
+bool LayoutNode::absorbsDirtyChild() const {
+    return parent_ && cache_.hasLayout && isRelayoutBoundary();
+}
+
+void LayoutNode::flagAncestorsForRelayout() {
+    for (LayoutNode* ancestor = parent_;
+         ancestor && !ancestor->hasDirtyDescendant_;
+         ancestor = ancestor->parent_) {
+        ancestor->hasDirtyDescendant_ = true;
+        if (!ancestor->parent_) {
+            ++ancestor->dirtyGeneration_;
+        }
+    }
+}
+
+void LayoutNode::unflagAncestorsForRelayout() {
+    for (LayoutNode* ancestor = parent_;
+         ancestor && ancestor->hasDirtyDescendant_ && !ancestor->isDirty_;
+         ancestor = ancestor->parent_) {
+        for (const LayoutNode* child : ancestor->children_) {
+            if (child->needsLayout()) {
+                return;
+            }
+        }
+        ancestor->hasDirtyDescendant_ = false;
+    }
+}
+
+bool LayoutNode::isRelayoutBoundary() const {
+    // Absolute children are framed from their own style and never
+    // affect their parent's layout
+    if (style_->positionType == PositionType::Absolute) {
+        return true;
+    }
+    
+    // In flow, the parent must not grow, stretch or resize it
+    const Style& style = *style_;
+    return style.width.unit == Unit::Point && style.width.value > 0.0f &&
+           style.height.unit == Unit::Point && style.height.value > 0.0f &&
+           style.flexGrow == 0.0f;
 }
 
 void LayoutNode::calculateLayout(float availableWidth, float availableHeight) {
@@ -87,16 +351,52 @@ void LayoutNode::calculateLayout(float availableWidth, float availableHeight) {
 
 Size LayoutNode::measure(float width, MeasureMode widthMode,
                          float height, MeasureMode heightMode) {
-    if (measureFunc_) {
-        return measureFunc_(width, widthMode, height, heightMode);
+    if (measureProvider_) {
+        LayoutConstraints constraints{width, widthMode, height, heightMode};
+        if (const Size* cached = cache_.findMeasurement(constraints)) {
+            return *cached;
+        }
+        
+        Size measured = measureProvider_->measure(measureContext_, width, widthMode,
+                                                  height, heightMode);
+        cache_.addMeasurement(constraints, measured);
+#ifdef OBSIDIAN_LAYOUT_NODE_STATS
+        ++layoutStats_.measureCalls;
+#endif
+        return measured;
     }
     
     // Default: return 0x0 for nodes without measure function
     return {0.0f, 0.0f};
 }
 
-void LayoutNode::printTree(int /* indent */) const {
-    // TODO: Implement debug tree printing
+void LayoutNode::printTree(int indent) const {
+    // Depth follows the walk: down one level into a first child, up as
+    // many as it climbed to reach the next node
+    int depth = 0;
+    for (const LayoutNode* node = this; node;) {
+        const LayoutResult& layout = node->getLayout();
+        std::printf("%*s%s{%g, %g, %g x %g}%s", (indent + depth) * 2, "",
+                    node->getChildCount() > 0 ? "container " : "node ",
+                    layout.left, layout.top, layout.width, layout.height,
+                    node->isDirty_ ? " dirty" : "");
+#ifdef OBSIDIAN_LAYOUT_NODE_STATS
+        const NodeLayoutStats& stats = node->layoutStats_;
+        std::printf(" layouts=%u reuses=%u measures=%u",
+                    stats.layouts, stats.reuses, stats.measureCalls);
+#endif
+        std::printf("\n");
+        
+        const LayoutNode* next = node->nextInPreOrder(this);
+        if (next && next->getParent() == node) {
+            ++depth;
+        } else if (next) {
+            for (const LayoutNode* up = node->getParent(); up != next->getParent(); up = up->getParent()) {
+                --depth;
+            }
+        }
+        node = next;
+    }
 }
 
 } // namespace obsidian::layout
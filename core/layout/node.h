@@ -12,12 +12,17 @@
 #pragma once
 
 #include "style.h"
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <span>
 
 namespace obsidian::layout {
 
+struct MeasureRequest;
+
 /**
  * Computed layout results
  * These are the output of the layout algorithm
@@ -43,6 +48,59 @@ struct LayoutResult {
     float bottom() const { return top + height; }
 };
 
+/**
+ * Why a node was marked dirty
+ */
+enum class DirtyReason : uint8_t {
+    Explicit,           // markDirty() called directly
+    StyleChanged,       // Style written or replaced
+    ChildrenChanged,    // Child inserted, removed or moved
+    MeasureChanged,     // Measure function or provider replaced
+    Relayout            // By the engine: a relayout boundary's parent must lay it out again
+};
+
+const char* dirtyReasonName(DirtyReason reason);
+
+class LayoutNode;
+
+/**
+ * A markDirty() that reached a layout root, or a relayout boundary that
+ * absorbed it. Recorded with OBSIDIAN_LAYOUT_INVALIDATIONS
+ * (--config=layout_invalidations). Nodes are identified by address
+ * only; they may have been destroyed since.
+ */
+struct Invalidation {
+    const LayoutNode* root = nullptr;       // Node the dirtiness stopped at
+    const LayoutNode* origin = nullptr;     // Node markDirty() was called on
+    DirtyReason reason = DirtyReason::Explicit;
+    uint32_t count = 0;                     // Times recorded since last taken
+};
+
+#ifdef OBSIDIAN_LAYOUT_NODE_STATS
+/**
+ * Layout counters of one node, accumulated over passes
+ * Compiled in with OBSIDIAN_LAYOUT_NODE_STATS (--config=layout_stats)
+ */
+struct NodeLayoutStats {
+    uint32_t layouts = 0;       // Times laid out
+    uint32_t reuses = 0;        // Times its cached layout was restored instead
+    uint32_t measureCalls = 0;  // Calls to its measure function
+};
+#endif
+
+/**
+ * Frame of a native view, relative to its parent view
+ */
+struct ViewFrame {
+    void* view = nullptr;
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    
+    bool operator==(const ViewFrame& other) const = default;
+};
+
 /**
  * Measure function type
  * Used for leaf nodes that have intrinsic size (e.g., text)
@@ -64,11 +122,102 @@ struct Size {
     float height = 0.0f;
 };
 
+struct Rect {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+/**
+ * Constraints a node was laid out under
+ * Used as the key when reusing a previous layout of a clean subtree.
+ */
+struct LayoutConstraints {
+    float width = 0.0f;
+    MeasureMode widthMode = MeasureMode::Undefined;
+    float height = 0.0f;
+    MeasureMode heightMode = MeasureMode::Undefined;
+    
+    bool operator==(const LayoutConstraints& other) const {
+        return width == other.width && widthMode == other.widthMode &&
+               height == other.height && heightMode == other.heightMode;
+    }
+    
+    bool operator!=(const LayoutConstraints& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * Per-node layout cache
+ * 
+ * Holds the last layout of a node's subtree and a few results of its
+ * measure function, each keyed by the constraints they were computed
+ * under. Cleared whenever the node is marked dirty.
+ */
+struct LayoutCache {
+    static constexpr size_t kMaxMeasurements = 4;
+    
+    struct Measurement {
+        LayoutConstraints constraints;
+        Size size;
+    };
+    
+    // Last layout of this subtree
+    LayoutConstraints layoutConstraints;
+    LayoutResult layout;
+    bool hasLayout = false;
+    
+    // Measure function results, replaced round-robin when full
+    Measurement measurements[kMaxMeasurements];
+    uint8_t measurementCount = 0;
+    uint8_t nextMeasurement = 0;
+    
+    const Size* findMeasurement(const LayoutConstraints& constraints) const;
+    void addMeasurement(const LayoutConstraints& constraints, Size size);
+    void clear();
+};
+
 using MeasureFunc = std::function<Size(
     float width, MeasureMode widthMode,
     float height, MeasureMode heightMode
 )>;
 
+/**
+ * Measure provider
+ * 
+ * Measures one kind of leaf (text, image, ...). All nodes of a kind
+ * share one provider and keep only their own context pointer, e.g.
+ * their text object, so a measurable node costs two pointers and a
+ * measurement is a plain function call. Providers are expected to
+ * outlive their nodes; typically they are static constants.
+ */
+struct MeasureProvider {
+    using Measure = Size (*)(void* context,
+                             float width, MeasureMode widthMode,
+                             float height, MeasureMode heightMode);
+    using MeasureBatch = void (*)(MeasureRequest* requests, size_t count);
+    using Release = void (*)(void* context);
+    
+    Measure measure = nullptr;
+    
+    // Optional: measures many nodes of this kind in one call, filling in
+    // each request's result (contexts via request.node). When set, the
+    // engine collects this kind's uncached measurements over a layout pass
+    // and hands them over together.
+    MeasureBatch measureBatch = nullptr;
+    
+    // Optional: called when a node lets go of its context
+    Release release = nullptr;
+};
+
+/**
+ * Provider installed by setMeasureFunc(): the context is a heap-allocated
+ * MeasureFunc, deleted on release
+ */
+extern const MeasureProvider kMeasureFuncProvider;
+
 /**
  * Layout Node
  * 
@@ -81,66 +230,171 @@ public:
     ~LayoutNode();
     
     // Style
-    Style& getStyle() { return style_; }
-    const Style& getStyle() const { return style_; }
+    // Styles are interned: nodes with equal styles share one immutable
+    // instance. Write access through getStyle() gives the node its own
+    // copy, which is interned again when the node is marked dirty or
+    // attached; references from getStyle() don't survive either.
+    Style& getStyle();
+    const Style& getStyle() const { return *style_; }
+    
+    // Replace the style; an unchanged style keeps the node clean
+    void setStyle(const Style& style);
+    
+    // Pointer comparison once both styles are interned
+    bool hasSameStyle(const LayoutNode& other) const;
     
     // Layout results (read-only from outside)
     const LayoutResult& getLayout() const { return layout_; }
     
     // Children
+    // Nodes know their index in the parent, so removeChild doesn't search;
+    // only the siblings after the removed child move.
     void addChild(LayoutNode* child);
     void insertChild(LayoutNode* child, size_t index);
     void removeChild(LayoutNode* child);
     void removeAllChildren();
     
+    // Bulk changes, marking this node dirty once: replace all children,
+    // or the `count` children from `first` on. Incoming children are
+    // detached from where they were, including elsewhere in this node.
+    void setChildren(std::span<LayoutNode* const> children);
+    void replaceChildren(size_t first, size_t count, std::span<LayoutNode* const> children);
+    
     size_t getChildCount() const { return children_.size(); }
     LayoutNode* getChild(size_t index) const;
     const std::vector<LayoutNode*>& getChildren() const { return children_; }
     
     // Parent
     LayoutNode* getParent() const { return parent_; }
+    size_t getIndexInParent() const { return indexInParent_; }
+    
+    // Next node of a pre-order walk over the subtree of `root`, nullptr
+    // after the last one; without `descend`, this node's children are
+    // skipped. Walks back up through parent links, so deep trees need no
+    // stack.
+    LayoutNode* nextInPreOrder(const LayoutNode* root, bool descend = true);
+    const LayoutNode* nextInPreOrder(const LayoutNode* root, bool descend = true) const;
     
     // Measure function (for leaf nodes like text)
+    // Wraps the function in a heap-allocated context; prefer a shared
+    // MeasureProvider for leaves that are created in large numbers.
     void setMeasureFunc(MeasureFunc func);
-    bool hasMeasureFunc() const { return measureFunc_ != nullptr; }
+    bool hasMeasureFunc() const { return measureProvider_ != nullptr; }
+    
+    // Measure provider and this node's context (nullptr provider clears)
+    void setMeasureProvider(const MeasureProvider* provider, void* context);
+    const MeasureProvider* getMeasureProvider() const { return measureProvider_; }
+    void* getMeasureContext() const { return measureContext_; }
     
     // Native view association (for applying layout)
     void setNativeView(void* view) { nativeView_ = view; }
     void* getNativeView() const { return nativeView_; }
     
     // Mark dirty (needs layout recalculation)
-    void markDirty();
+    void markDirty(DirtyReason reason = DirtyReason::Explicit);
     bool isDirty() const { return isDirty_; }
     
+    // Dirty itself, or has a dirty relayout boundary below it
+    bool needsLayout() const { return isDirty_ || hasDirtyDescendant_; }
+    
+    // Move the invalidations recorded in this node's tree since they were
+    // last taken into `out` (replacing its contents), e.g. right before
+    // laying the tree out. Always empty unless built with
+    // OBSIDIAN_LAYOUT_INVALIDATIONS, which records nothing otherwise.
+    void takeInvalidations(std::vector<Invalidation>& out);
+    
+    // Relayout boundary: a node whose frame doesn't depend on its content
+    // (absolutely positioned, or a fixed point size its parent can't grow).
+    // Dirtiness from its descendants stops here, and the engine lays out
+    // the boundary's subtree on its own.
+    bool isRelayoutBoundary() const;
+    
     // Calculate layout (main entry point)
     // Call on root node with available space
     void calculateLayout(float availableWidth, float availableHeight);
     
     // Debug
+    // Print the subtree with its frames (and counters, when compiled in)
     void printTree(int indent = 0) const;
+    
+#ifdef OBSIDIAN_LAYOUT_NODE_STATS
+    const NodeLayoutStats& getLayoutStats() const { return layoutStats_; }
+    void resetLayoutStats() { layoutStats_ = {}; }
+#endif
 
 private:
     friend class LayoutEngine;
+    friend class ResizeLayoutCache;
+    friend class FrameBuffer;
+    friend class LayoutRecording;
     
     // Internal layout computation
     Size measure(float width, MeasureMode widthMode, 
                  float height, MeasureMode heightMode);
     
+    // Whether dirtiness from a child stops here: a boundary that was laid
+    // out before can be laid out again on its own
+    bool absorbsDirtyChild() const;
+    
+    // Record on ancestors that this relayout boundary waits for layout
+    void flagAncestorsForRelayout();
+    
+    // Undo that once it was laid out on its own, up to the first ancestor
+    // that still leads to another dirty node
+    void unflagAncestorsForRelayout();
+    
+#ifdef OBSIDIAN_LAYOUT_INVALIDATIONS
+    // Count a markDirty() of this node stopping at `root`, in the tree root
+    void recordInvalidation(const LayoutNode* root, DirtyReason reason);
+#endif
+    
+    // Share the node's own style copy through the interner
+    void internStyle();
+    
+    // Refresh indexInParent_ of the children from `from` on
+    void reindexChildren(size_t from);
+    
     // Apply computed layout to this node
     void setLayout(const LayoutResult& result) { layout_ = result; }
     LayoutResult& getMutableLayout() { return layout_; }
     
-    Style style_;
+    SharedStyle style_ = StyleInterner::defaultStyle();
     LayoutResult layout_;
     
     LayoutNode* parent_ = nullptr;
     std::vector<LayoutNode*> children_;
+    size_t indexInParent_ = 0;  // Valid while parent_ is set
     
-    MeasureFunc measureFunc_;
+    const MeasureProvider* measureProvider_ = nullptr;
+    void* measureContext_ = nullptr;
     void* nativeView_ = nullptr;
     
+    // Frame last set on nativeView_ when layout was applied
+    ViewFrame appliedFrame_;
+    
+#ifdef OBSIDIAN_LAYOUT_NODE_STATS
+    NodeLayoutStats layoutStats_;
+#endif
+    
+#ifdef OBSIDIAN_LAYOUT_INVALIDATIONS
+    // On a root: invalidations of its tree not yet taken
+    std::vector<Invalidation> invalidations_;
+#endif
+    
     bool isDirty_ = true;
     
+    // style_ is the interned instance, not a private copy
+    bool styleInterned_ = true;
+    
+    // A relayout boundary below this node is dirty
+    bool hasDirtyDescendant_ = false;
+    
+    // On a root: bumped whenever dirtiness reaches it
+    uint32_t dirtyGeneration_ = 0;
+    
+    // Results reused while the node is clean
+    LayoutCache cache_;
+    
     // Non-copyable
     LayoutNode(const LayoutNode&) = delete;
     LayoutNode& operator=(const LayoutNode&) = delete;
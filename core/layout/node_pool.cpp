@@ -0,0 +1,101 @@
+/**
+ * Obsidian Layout Engine - View Node Pool Implementation
+ */
+
+#include "node_pool.h"
+#include "view_node.h"
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace obsidian::layout {
+
+struct ViewNodePool::Slot {
+    alignas(ViewNode) unsigned char storage[sizeof(ViewNode)];
+};
+
+struct ViewNodePool::Arena {
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    std::vector<Slot*> freeSlots;
+    size_t liveCount = 0;
+    bool orphaned = false;  // The pool is gone; freed with the last node
+
+    void addSlab() {
+        slabs.push_back(std::make_unique<Slot[]>(kSlabSize));
+        Slot* slab = slabs.back().get();
+
+        // Push in reverse so allocation walks the slab front to back
+        for (size_t i = kSlabSize; i > 0; --i) {
+            freeSlots.push_back(&slab[i - 1]);
+        }
+    }
+};
+
+static thread_local ViewNodePool* currentPool = nullptr;
+
+ViewNodePool::ViewNodePool()
+    : arena_(new Arena()) {
+}
+
+ViewNodePool::~ViewNodePool() {
+    // Nodes still alive belong to their owners, who free them later
+    if (arena_->liveCount == 0) {
+        delete arena_;
+    } else {
+        arena_->orphaned = true;
+    }
+}
+
+ViewNode* ViewNodePool::create() {
+    if (arena_->freeSlots.empty()) {
+        arena_->addSlab();
+    }
+
+    Slot* slot = arena_->freeSlots.back();
+    arena_->freeSlots.pop_back();
+
+    auto* node = new (slot->storage) ViewNode();
+    node->arena_ = arena_;
+    ++arena_->liveCount;
+    return node;
+}
+
+void ViewNodePool::destroy(ViewNode* node) {
+    if (!node || node->arena_ != arena_) return;
+    release(node);
+}
+
+void ViewNodePool::release(ViewNode* node) {
+    Arena* arena = node->arena_;
+
+    // storage is the first member, so the node address is the slot address
+    auto* slot = reinterpret_cast<Slot*>(node);
+    node->~ViewNode();
+    arena->freeSlots.push_back(slot);
+    if (--arena->liveCount == 0 && arena->orphaned) {
+        delete arena;
+    }
+}
+
+size_t ViewNodePool::getLiveCount() const {
+    return arena_->liveCount;
+}
+
+size_t ViewNodePool::getCapacity() const {
+    return arena_->slabs.size() * kSlabSize;
+}
+
+ViewNodePool* ViewNodePool::current() {
+    return currentPool;
+}
+
+ViewNodePool::Scope::Scope(ViewNodePool& pool)
+    : previous_(currentPool) {
+    currentPool = &pool;
+}
+
+ViewNodePool::Scope::~Scope() {
+    currentPool = previous_;
+}
+
+} // namespace obsidian::layout
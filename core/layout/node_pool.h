@@ -0,0 +1,94 @@
+/**
+ * Obsidian Layout Engine - View Node Pool
+ *
+ * Slab allocator for ViewNodes, one per surface (screen/window).
+ *
+ * Ownership model:
+ * - The pool owns the memory, not the nodes: each ViewNode has a single
+ *   owner (the component that created it, or its parent node, see
+ *   ViewNode) that frees it with ViewNode::destroy()
+ * - destroy() returns a node's slot to its pool for reuse
+ * - The slabs live until both the pool and its last node are gone, so
+ *   components may outlive the pool they were built from
+ *
+ * Nodes are allocated from the pool made current with ViewNodePool::Scope.
+ * Outside any scope, ViewNodes are heap-allocated as before.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace obsidian::layout {
+
+class ViewNode;
+
+/**
+ * ViewNodePool
+ *
+ * Nodes are carved out of fixed-size slabs, so allocation is a free-list
+ * pop and slots of destroyed nodes are reused by later allocations.
+ */
+class ViewNodePool {
+public:
+    static constexpr size_t kSlabSize = 64;
+
+    ViewNodePool();
+    ~ViewNodePool();
+
+    /**
+     * Allocate a default-constructed ViewNode from this pool
+     */
+    ViewNode* create();
+
+    /**
+     * Destroy a single node and return its slot to the free list.
+     * The node must have been allocated from this pool.
+     */
+    void destroy(ViewNode* node);
+
+    size_t getLiveCount() const;
+    size_t getCapacity() const;
+
+    /**
+     * Pool used by ViewNode factories on this thread, or nullptr
+     */
+    static ViewNodePool* current();
+
+    /**
+     * Makes a pool current for the lifetime of the scope (nestable)
+     */
+    class Scope {
+    public:
+        explicit Scope(ViewNodePool& pool);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ViewNodePool* previous_;
+    };
+
+    /**
+     * Slabs of a pool, shared with its live nodes (opaque)
+     */
+    struct Arena;
+
+private:
+    friend class ViewNode;
+
+    struct Slot;
+
+    // Destroy a pooled node and free its slot, and the arena after the
+    // pool and its last node are gone
+    static void release(ViewNode* node);
+
+    Arena* arena_;
+
+    // Non-copyable
+    ViewNodePool(const ViewNodePool&) = delete;
+    ViewNodePool& operator=(const ViewNodePool&) = delete;
+};
+
+} // namespace obsidian::layout
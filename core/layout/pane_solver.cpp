@@ -0,0 +1,197 @@
+/**
+ * Obsidian Layout Engine - Pane Constraint Solver Implementation
+ */
+
+#include "pane_solver.h"
+#include <algorithm>
+
+namespace obsidian::layout {
+
+PaneSolver::PaneSolver(FlexDirection direction)
+    : direction_(direction) {}
+
+size_t PaneSolver::addPane(float size, float minSize, float maxSize, PaneStrength strength) {
+    Pane pane;
+    pane.stay = size;
+    pane.minSize = minSize;
+    pane.maxSize = std::max(minSize, maxSize);
+    pane.strength = strength;
+    panes_.push_back(pane);
+    return panes_.size() - 1;
+}
+
+void PaneSolver::setPaneContent(size_t pane, LayoutNode* content) {
+    if (pane >= panes_.size()) return;
+
+    panes_[pane].content = content;
+    panes_[pane].laidOutMain = -1.0f;
+}
+
+void PaneSolver::setPaneLimits(size_t pane, float minSize, float maxSize) {
+    if (pane >= panes_.size()) return;
+
+    panes_[pane].minSize = minSize;
+    panes_[pane].maxSize = std::max(minSize, maxSize);
+}
+
+void PaneSolver::setPaneStrength(size_t pane, PaneStrength strength) {
+    if (pane >= panes_.size()) return;
+
+    panes_[pane].strength = strength;
+}
+
+void PaneSolver::setPaneSize(size_t pane, float size) {
+    if (pane >= panes_.size()) return;
+
+    panes_[pane].stay = size;
+}
+
+void PaneSolver::setCollapsed(size_t pane, bool collapsed) {
+    if (pane >= panes_.size()) return;
+
+    // The stay is kept, so expanding restores the size
+    panes_[pane].collapsed = collapsed;
+}
+
+bool PaneSolver::isCollapsed(size_t pane) const {
+    return pane < panes_.size() && panes_[pane].collapsed;
+}
+
+void PaneSolver::setDividerThickness(float thickness) {
+    dividerThickness_ = std::max(thickness, 0.0f);
+}
+
+void PaneSolver::setContainerSize(float width, float height) {
+    bool row = direction_ == FlexDirection::Row || direction_ == FlexDirection::RowReverse;
+    mainSize_ = row ? width : height;
+    crossSize_ = row ? height : width;
+}
+
+void PaneSolver::beginEdit(size_t divider) {
+    if (divider + 1 >= panes_.size()) return;
+
+    editing_ = true;
+    editDivider_ = divider;
+    editPosition_ = getDividerPosition(divider);
+}
+
+bool PaneSolver::suggestDividerPosition(float position) {
+    if (!editing_) return false;
+
+    editPosition_ = position;
+    return solve();
+}
+
+void PaneSolver::endEdit() {
+    if (!editing_) return;
+
+    // The dragged sizes become the ones panes keep; collapsed panes keep
+    // the size they expand to
+    editing_ = false;
+    for (Pane& pane : panes_) {
+        if (!pane.collapsed) pane.stay = pane.size;
+    }
+}
+
+bool PaneSolver::solve() {
+    if (panes_.empty()) return false;
+
+    for (Pane& pane : panes_) {
+        pane.previousSize = pane.size;
+        pane.size = std::clamp(pane.stay, minSizeOf(pane), maxSizeOf(pane));
+    }
+
+    float dividers = dividerThickness_ * static_cast<float>(panes_.size() - 1);
+    float available = std::max(mainSize_ - dividers, 0.0f);
+
+    auto sumOf = [&](size_t first, size_t last, auto&& value) {
+        float sum = 0.0f;
+        for (size_t i = first; i < last; ++i) sum += value(panes_[i]);
+        return sum;
+    };
+    auto size = [](const Pane& pane) { return pane.size; };
+    auto minSize = [this](const Pane& pane) { return minSizeOf(pane); };
+    auto maxSize = [this](const Pane& pane) { return maxSizeOf(pane); };
+
+    if (editing_) {
+        // Panes up to the divider take the space before it, within what
+        // both sides can take; the panes nearest the divider move first
+        size_t split = editDivider_ + 1;
+        float leading = editPosition_ - dividerThickness_ * static_cast<float>(editDivider_);
+        float lowest = std::max(sumOf(0, split, minSize), available - sumOf(split, panes_.size(), maxSize));
+        float highest = std::min(sumOf(0, split, maxSize), available - sumOf(split, panes_.size(), minSize));
+        leading = std::min(std::max(leading, lowest), highest);
+
+        distribute(0, split, leading - sumOf(0, split, size), false);
+        distribute(split, panes_.size(), (available - leading) - sumOf(split, panes_.size(), size), true);
+    } else {
+        // Trailing panes absorb container resizes first
+        distribute(0, panes_.size(), available - sumOf(0, panes_.size(), size), false);
+    }
+
+    bool changed = false;
+    float offset = 0.0f;
+    for (Pane& pane : panes_) {
+        pane.offset = offset;
+        offset += pane.size + dividerThickness_;
+        changed = changed || pane.size != pane.previousSize;
+    }
+    return changed;
+}
+
+void PaneSolver::distribute(size_t first, size_t last, float delta, bool towardsFirst) {
+    order_.clear();
+    for (size_t i = first; i < last; ++i) {
+        if (!panes_[i].collapsed) order_.push_back(i);
+    }
+    std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b) {
+        if (panes_[a].strength != panes_[b].strength) {
+            return panes_[a].strength < panes_[b].strength;
+        }
+        return towardsFirst ? a < b : a > b;
+    });
+
+    for (size_t i : order_) {
+        if (delta == 0.0f) break;
+
+        Pane& pane = panes_[i];
+        float target = std::clamp(pane.size + delta, pane.minSize, pane.maxSize);
+        delta -= target - pane.size;
+        pane.size = target;
+    }
+}
+
+float PaneSolver::getPaneSize(size_t pane) const {
+    return pane < panes_.size() ? panes_[pane].size : 0.0f;
+}
+
+float PaneSolver::getPaneOffset(size_t pane) const {
+    return pane < panes_.size() ? panes_[pane].offset : 0.0f;
+}
+
+float PaneSolver::getDividerPosition(size_t divider) const {
+    if (divider + 1 >= panes_.size()) return 0.0f;
+
+    return panes_[divider].offset + panes_[divider].size;
+}
+
+size_t PaneSolver::layoutChangedPanes(const LayoutOptions& options) {
+    bool row = direction_ == FlexDirection::Row || direction_ == FlexDirection::RowReverse;
+
+    size_t laidOut = 0;
+    for (Pane& pane : panes_) {
+        if (!pane.content || pane.collapsed) continue;
+        bool sizeChanged = pane.size != pane.laidOutMain || crossSize_ != pane.laidOutCross;
+        if (!sizeChanged && !pane.content->needsLayout()) continue;
+
+        float width = row ? pane.size : crossSize_;
+        float height = row ? crossSize_ : pane.size;
+        LayoutEngine::calculateLayout(pane.content, width, height, options);
+        pane.laidOutMain = pane.size;
+        pane.laidOutCross = crossSize_;
+        ++laidOut;
+    }
+    return laidOut;
+}
+
+} // namespace obsidian::layout
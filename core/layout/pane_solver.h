@@ -0,0 +1,164 @@
+/**
+ * Obsidian Layout Engine - Pane Constraint Solver
+ *
+ * Sizes the panes of a split container (split views, sidebars) along
+ * one axis, in the manner of an incremental Cassowary solver restricted
+ * to a row of panes:
+ *
+ * - Required: each pane stays within its min/max size (0 when collapsed),
+ *   and the panes plus dividers fill the container.
+ * - Edit: while a divider is dragged, its position follows the pointer as
+ *   far as the required constraints allow.
+ * - Stay: otherwise each pane keeps its size. Panes with weaker stays
+ *   give way first; among equals, the panes nearest the dragged divider,
+ *   or the trailing panes on a container resize.
+ *
+ * Solving is linear in the number of panes, and stays come from the last
+ * committed sizes, so a drag re-solves from the same state on every
+ * pointer move. Each pane's content is the root of its own layout tree;
+ * only panes whose size changed are laid out again.
+ */
+
+#pragma once
+
+#include "engine.h"
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace obsidian::layout {
+
+/**
+ * How strongly a pane keeps its size when others change
+ */
+enum class PaneStrength {
+    Weak,       // Absorbs container resizes and drags first
+    Medium,
+    Strong      // Gives way only when weaker panes hit their limits
+};
+
+/**
+ * Pane Solver
+ *
+ * Panes are indexed in order along the axis; divider i sits between
+ * pane i and pane i + 1.
+ */
+class PaneSolver {
+public:
+    static constexpr float kUnbounded = std::numeric_limits<float>::infinity();
+
+    /**
+     * @param direction Axis of the panes: Row (or RowReverse) for
+     *                  side-by-side panes, Column for stacked ones
+     */
+    explicit PaneSolver(FlexDirection direction = FlexDirection::Row);
+
+    /**
+     * Add a pane after the existing ones
+     * @param size Size the pane keeps (its stay) while nothing forces it
+     * @return Index of the pane
+     */
+    size_t addPane(float size, float minSize = 0.0f, float maxSize = kUnbounded,
+                   PaneStrength strength = PaneStrength::Weak);
+
+    /**
+     * Root of the layout tree shown in a pane, laid out at the pane's size
+     */
+    void setPaneContent(size_t pane, LayoutNode* content);
+
+    void setPaneLimits(size_t pane, float minSize, float maxSize);
+    void setPaneStrength(size_t pane, PaneStrength strength);
+
+    /**
+     * Change the size a pane keeps (e.g. restored from saved state)
+     */
+    void setPaneSize(size_t pane, float size);
+
+    /**
+     * Collapse a pane to 0, or give it back its kept size
+     */
+    void setCollapsed(size_t pane, bool collapsed);
+    bool isCollapsed(size_t pane) const;
+
+    void setDividerThickness(float thickness);
+
+    /**
+     * Size of the container; the panes fill its main axis
+     */
+    void setContainerSize(float width, float height);
+
+    /**
+     * Drag a divider
+     * suggestDividerPosition() re-solves for a divider position, measured
+     * from the container's leading edge. endEdit() keeps the resulting
+     * sizes as the panes' new stays.
+     * @return true if a pane size changed
+     */
+    void beginEdit(size_t divider);
+    bool suggestDividerPosition(float position);
+    void endEdit();
+    bool isEditing() const { return editing_; }
+
+    /**
+     * Re-solve after changes to the panes or the container
+     * Called by suggestDividerPosition(); the setters don't solve.
+     * @return true if a pane size changed
+     */
+    bool solve();
+
+    /**
+     * Solved geometry, along the main axis
+     */
+    size_t getPaneCount() const { return panes_.size(); }
+    float getPaneSize(size_t pane) const;
+    float getPaneOffset(size_t pane) const;
+    float getDividerPosition(size_t divider) const;
+
+    /**
+     * Lay out the content of the panes whose size changed since their
+     * last layout, or whose content needs layout (see
+     * LayoutNode::needsLayout), at their solved size
+     * @return Number of panes laid out
+     */
+    size_t layoutChangedPanes(const LayoutOptions& options = LayoutOptions{});
+
+private:
+    struct Pane {
+        float stay = 0.0f;
+        float minSize = 0.0f;
+        float maxSize = kUnbounded;
+        PaneStrength strength = PaneStrength::Weak;
+        bool collapsed = false;
+        LayoutNode* content = nullptr;
+
+        float size = 0.0f;      // Solved
+        float offset = 0.0f;
+        float previousSize = 0.0f;
+
+        float laidOutMain = -1.0f;   // Size the content was last laid out at
+        float laidOutCross = -1.0f;
+    };
+
+    float minSizeOf(const Pane& pane) const { return pane.collapsed ? 0.0f : pane.minSize; }
+    float maxSizeOf(const Pane& pane) const { return pane.collapsed ? 0.0f : pane.maxSize; }
+
+    // Spread `delta` over panes [first, last), weaker stays first, then
+    // from the first or the last pane on, each within its limits. What
+    // no pane can take is left over (the constraints conflict).
+    void distribute(size_t first, size_t last, float delta, bool towardsFirst);
+
+    FlexDirection direction_;
+    std::vector<Pane> panes_;
+    float dividerThickness_ = 1.0f;
+    float mainSize_ = 0.0f;
+    float crossSize_ = 0.0f;
+
+    bool editing_ = false;
+    size_t editDivider_ = 0;
+    float editPosition_ = 0.0f;
+
+    // Distribution order scratch
+    std::vector<size_t> order_;
+};
+
+} // namespace obsidian::layout
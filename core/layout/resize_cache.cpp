@@ -0,0 +1,106 @@
+/**
+ * Obsidian Layout Engine - Resize Layout Cache Implementation
+ */
+
+#include "resize_cache.h"
+#include "engine.h"
+#include <algorithm>
+
+namespace obsidian::layout {
+
+ResizeLayoutCache::ResizeLayoutCache(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)) {
+    entries_.reserve(capacity_);
+}
+
+bool ResizeLayoutCache::calculateLayout(LayoutNode* root, float width, float height) {
+    if (!root) return false;
+
+    if (restore(root, width, height)) {
+        return true;
+    }
+
+    LayoutEngine::calculateLayout(root, width, height);
+    store(root, width, height);
+    return false;
+}
+
+bool ResizeLayoutCache::isClean(const LayoutNode* root) {
+    return !root->isDirty_ && !root->hasDirtyDescendant_ && root->cache_.hasLayout;
+}
+
+bool ResizeLayoutCache::restore(LayoutNode* root, float width, float height) {
+    if (!root || root->getParent() || !isClean(root)) return false;
+
+    auto it = std::find_if(entries_.begin(), entries_.end(), [&](const Entry& entry) {
+        return entry.width == width && entry.height == height &&
+               entry.generation == root->dirtyGeneration_;
+    });
+    if (it == entries_.end()) return false;
+
+    if (!restoreFrames(root, it->frames)) {
+        // The tree no longer has the shape it was saved with; the frames
+        // just written are wrong, so force a full layout
+        entries_.clear();
+        root->markDirty(DirtyReason::Relayout);
+        return false;
+    }
+
+    // The root now holds a layout at this size, as if just calculated
+    LayoutConstraints constraints{width, MeasureMode::Exactly, height, MeasureMode::Exactly};
+    root->cache_.layoutConstraints = constraints;
+    root->cache_.layout = root->getLayout();
+    root->cache_.hasLayout = true;
+
+    std::rotate(entries_.begin(), it, it + 1);
+    return true;
+}
+
+void ResizeLayoutCache::store(LayoutNode* root, float width, float height) {
+    if (!root || root->getParent() || !isClean(root)) return;
+
+    // Frame sets from an older generation can't be restored anymore
+    uint32_t generation = root->dirtyGeneration_;
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [&](const Entry& entry) {
+        return entry.generation != generation ||
+               (entry.width == width && entry.height == height);
+    }), entries_.end());
+
+    // Reuse the least recently used entry's storage when full
+    Entry entry;
+    if (entries_.size() >= capacity_) {
+        entry = std::move(entries_.back());
+        entries_.pop_back();
+    }
+    entry.width = width;
+    entry.height = height;
+    entry.generation = generation;
+    entry.frames.clear();
+    saveFrames(root, entry.frames);
+
+    entries_.insert(entries_.begin(), std::move(entry));
+}
+
+void ResizeLayoutCache::saveFrames(const LayoutNode* root, std::vector<LayoutResult>& frames) {
+    for (const LayoutNode* node = root; node; node = node->nextInPreOrder(root)) {
+        frames.push_back(node->getLayout());
+    }
+}
+
+bool ResizeLayoutCache::restoreFrames(LayoutNode* root, const std::vector<LayoutResult>& frames) {
+    size_t index = 0;
+    for (LayoutNode* node = root; node; node = node->nextInPreOrder(root)) {
+        if (index >= frames.size()) return false;
+
+        node->layout_ = frames[index++];
+
+        // Subtree caches describe the size the tree was last calculated at;
+        // only the root's is brought in line with the restored frames
+        if (node != root) {
+            node->cache_.hasLayout = false;
+        }
+    }
+    return index == frames.size();
+}
+
+} // namespace obsidian::layout
@@ -0,0 +1,72 @@
+/**
+ * Obsidian Layout Engine - Resize Layout Cache
+ *
+ * Remembers the frames of a layout tree for the last few root sizes.
+ * While the tree is unchanged its layout depends only on the size it
+ * is laid out at, so going back to a recent size (dragging a window
+ * edge back and forth, toggling full screen) restores the frames
+ * instead of recomputing them.
+ *
+ * Entries are tied to the root's dirty generation: any markDirty()
+ * that reaches the root makes every cached frame set stale.
+ */
+
+#pragma once
+
+#include "node.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace obsidian::layout {
+
+/**
+ * Resize Layout Cache
+ *
+ * Bounded, least-recently-used cache for one root.
+ */
+class ResizeLayoutCache {
+public:
+    static constexpr size_t kDefaultCapacity = 8;
+
+    explicit ResizeLayoutCache(size_t capacity = kDefaultCapacity);
+
+    /**
+     * Lay the root out at a size, restoring the frames when cached
+     * @return true when the frames came from the cache
+     */
+    bool calculateLayout(LayoutNode* root, float width, float height);
+
+    /**
+     * Restore the frames for a size if cached and still valid
+     */
+    bool restore(LayoutNode* root, float width, float height);
+
+    /**
+     * Remember the current frames of a clean root, laid out at a size
+     */
+    void store(LayoutNode* root, float width, float height);
+
+    void clear() { entries_.clear(); }
+    size_t size() const { return entries_.size(); }
+    size_t getCapacity() const { return capacity_; }
+
+private:
+    struct Entry {
+        float width = 0.0f;
+        float height = 0.0f;
+        uint32_t generation = 0;
+        std::vector<LayoutResult> frames;  // Pre-order
+    };
+
+    static bool isClean(const LayoutNode* root);
+    static void saveFrames(const LayoutNode* root, std::vector<LayoutResult>& frames);
+    static bool restoreFrames(LayoutNode* root, const std::vector<LayoutResult>& frames);
+
+    size_t capacity_;
+
+    // Most recently used first
+    std::vector<Entry> entries_;
+};
+
+} // namespace obsidian::layout
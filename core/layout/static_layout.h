@@ -0,0 +1,489 @@
+/**
+ * Obsidian Layout Engine - Static Layout
+ *
+ * Compile-time specialized layout for view trees that are fully known
+ * while compiling: static VStack/HStack/Spacer compositions of
+ * fixed-size leaves, such as window chrome.
+ *
+ * The tree is described with constexpr builders over the usual Style
+ * and flattened into a StaticTree. StaticLayout<tree> is a layout
+ * function specialized for that one tree: style lookups, unit checks
+ * and alignment choices are all resolved by the compiler, leaving only
+ * the arithmetic that depends on the available size. The same function
+ * runs in constant expressions, so the frames for a known window size
+ * can be precomputed outright:
+ *
+ *   static constexpr auto kToolbar = staticHStack(8.0f,
+ *       staticLeaf(32.0f, 32.0f), staticSpacer(), staticLeaf(120.0f, 32.0f));
+ *
+ *   constexpr auto frames = StaticLayout<kToolbar>::calculate(1280.0f, 44.0f);
+ *
+ * Results match LayoutEngine::calculateLayout on the equivalent
+ * LayoutNode tree, one LayoutResult per node in builder (pre-)order.
+ * Leaves have no measure function; their size comes from their style.
+ */
+
+#pragma once
+
+#include "node.h"
+#include "style.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace obsidian::layout {
+
+/**
+ * Node of a static tree
+ */
+struct StaticNode {
+    Style style;
+    uint32_t childCount = 0;
+    uint32_t subtreeSize = 1;   // This node and all of its descendants
+};
+
+/**
+ * Static tree of N nodes, stored in pre-order:
+ * each node is directly followed by its subtree
+ */
+template <size_t N>
+struct StaticTree {
+    static constexpr size_t kNodeCount = N;
+
+    std::array<StaticNode, N> nodes{};
+};
+
+/**
+ * Leaf with the given style
+ */
+constexpr StaticTree<1> staticLeaf(const Style& style) {
+    StaticTree<1> tree;
+    tree.nodes[0].style = style;
+    return tree;
+}
+
+/**
+ * Leaf of a fixed point size
+ */
+constexpr StaticTree<1> staticLeaf(float width, float height) {
+    Style style;
+    style.width = LayoutValue::points(width);
+    style.height = LayoutValue::points(height);
+    return staticLeaf(style);
+}
+
+/**
+ * Spacer (flexGrow = 1)
+ */
+constexpr StaticTree<1> staticSpacer() {
+    Style style;
+    style.flexGrow = 1.0f;
+    return staticLeaf(style);
+}
+
+/**
+ * Container with the given style and children
+ */
+template <size_t... Ns>
+constexpr StaticTree<1 + (Ns + ... + 0)> staticContainer(const Style& style,
+                                                          const StaticTree<Ns>&... children) {
+    StaticTree<1 + (Ns + ... + 0)> tree;
+    tree.nodes[0].style = style;
+    tree.nodes[0].childCount = static_cast<uint32_t>(sizeof...(Ns));
+    tree.nodes[0].subtreeSize = static_cast<uint32_t>(1 + (Ns + ... + 0));
+
+    size_t next = 1;
+    ([&] {
+        for (size_t i = 0; i < Ns; ++i) {
+            tree.nodes[next++] = children.nodes[i];
+        }
+    }(), ...);
+    return tree;
+}
+
+/**
+ * VStack (Column) with spacing between children
+ */
+template <size_t... Ns>
+constexpr auto staticVStack(float spacing, const StaticTree<Ns>&... children) {
+    Style style;
+    style.flexDirection = FlexDirection::Column;
+    style.gap = spacing;
+    return staticContainer(style, children...);
+}
+
+/**
+ * HStack (Row) with spacing between children
+ */
+template <size_t... Ns>
+constexpr auto staticHStack(float spacing, const StaticTree<Ns>&... children) {
+    Style style;
+    style.flexDirection = FlexDirection::Row;
+    style.gap = spacing;
+    return staticContainer(style, children...);
+}
+
+/**
+ * Layout function specialized for one static tree
+ *
+ * Tree must be a constexpr StaticTree with static storage duration.
+ */
+template <const auto& Tree>
+class StaticLayout {
+public:
+    static constexpr size_t kNodeCount = std::remove_cvref_t<decltype(Tree)>::kNodeCount;
+
+    using Results = std::array<LayoutResult, kNodeCount>;
+
+    /**
+     * Lay the tree out in the available space (the root is sized exactly)
+     */
+    static constexpr Results calculate(float availableWidth, float availableHeight) {
+        Results results{};
+        calculate(availableWidth, availableHeight, results);
+        return results;
+    }
+
+    static constexpr void calculate(float availableWidth, float availableHeight, Results& results) {
+        results = Results{};
+
+        constexpr const Style& style = Tree.nodes[0].style;
+        LayoutResult& layout = results[0];
+
+        layout.width = resolveRootDimension<true>(availableWidth);
+        layout.height = resolveRootDimension<false>(availableHeight);
+
+        layout.paddingLeft = resolve<style.padding[0].unit>(style.padding[0].value, layout.width);
+        layout.paddingTop = resolve<style.padding[1].unit>(style.padding[1].value, layout.height);
+        layout.paddingRight = resolve<style.padding[2].unit>(style.padding[2].value, layout.width);
+        layout.paddingBottom = resolve<style.padding[3].unit>(style.padding[3].value, layout.height);
+
+        if constexpr (Tree.nodes[0].childCount > 0) {
+            layoutFlexContainer<0>(results);
+        }
+        layoutAbsoluteChildren(results);
+    }
+
+private:
+    // Running totals of a container's layout passes
+    struct FlexState {
+        float contentWidth = 0.0f;
+        float contentHeight = 0.0f;
+        float mainAxisSize = 0.0f;
+        float crossAxisSize = 0.0f;
+        float totalFixedSize = 0.0f;
+        float maxChildCrossSize = 0.0f;
+        float flexGrowUnit = 0.0f;
+        float mainOffset = 0.0f;
+        float interItemSpace = 0.0f;
+        size_t flowIndex = 0;
+    };
+
+    // Index of the k-th child of a node
+    static constexpr size_t childIndex(size_t node, size_t k) {
+        size_t child = node + 1;
+        for (size_t i = 0; i < k; ++i) {
+            child += Tree.nodes[child].subtreeSize;
+        }
+        return child;
+    }
+
+    static constexpr bool isInFlow(size_t node) {
+        return Tree.nodes[node].style.positionType == PositionType::Relative;
+    }
+
+    static constexpr size_t flowCount(size_t node) {
+        size_t count = 0;
+        for (size_t k = 0; k < Tree.nodes[node].childCount; ++k) {
+            if (isInFlow(childIndex(node, k))) ++count;
+        }
+        return count;
+    }
+
+    static constexpr float totalFlexGrow(size_t node) {
+        float total = 0.0f;
+        for (size_t k = 0; k < Tree.nodes[node].childCount; ++k) {
+            size_t child = childIndex(node, k);
+            if (isInFlow(child)) total += Tree.nodes[child].style.flexGrow;
+        }
+        return total;
+    }
+
+    static constexpr bool isColumn(FlexDirection direction) {
+        return direction == FlexDirection::Column || direction == FlexDirection::ColumnReverse;
+    }
+
+    // Resolve a value whose unit is known while compiling
+    template <Unit U>
+    static constexpr float resolve(float value, float parentSize) {
+        if constexpr (U == Unit::Point) {
+            return value;
+        } else if constexpr (U == Unit::Percent) {
+            return value * parentSize / 100.0f;
+        } else {
+            return 0.0f;
+        }
+    }
+
+    // Root dimension: its style, or exactly the available size
+    template <bool Width>
+    static constexpr float resolveRootDimension(float available) {
+        constexpr const Style& style = Tree.nodes[0].style;
+        constexpr const LayoutValue& size = Width ? style.width : style.height;
+        constexpr const LayoutValue& minSize = Width ? style.minWidth : style.minHeight;
+        constexpr const LayoutValue& maxSize = Width ? style.maxWidth : style.maxHeight;
+
+        float resolved = available;
+        if constexpr (size.isDefined()) {
+            resolved = resolve<size.unit>(size.value, available);
+        }
+        if constexpr (minSize.isDefined()) {
+            resolved = std::max(resolved, resolve<minSize.unit>(minSize.value, available));
+        }
+        if constexpr (maxSize.isDefined()) {
+            resolved = std::min(resolved, resolve<maxSize.unit>(maxSize.value, available));
+        }
+        return resolved;
+    }
+
+    static constexpr AlignItems resolveAlignment(AlignItems alignItems, AlignSelf alignSelf) {
+        switch (alignSelf) {
+            case AlignSelf::FlexStart: return AlignItems::FlexStart;
+            case AlignSelf::FlexEnd: return AlignItems::FlexEnd;
+            case AlignSelf::Center: return AlignItems::Center;
+            case AlignSelf::Stretch: return AlignItems::Stretch;
+            default: return alignItems;
+        }
+    }
+
+    template <size_t Node>
+    static constexpr void layoutFlexContainer(Results& results) {
+        constexpr const Style& style = Tree.nodes[Node].style;
+        static_assert(style.display == Display::Flex, "StaticLayout supports flex containers only");
+        constexpr bool column = isColumn(style.flexDirection);
+        constexpr bool reverse = (style.flexDirection == FlexDirection::ColumnReverse ||
+                                  style.flexDirection == FlexDirection::RowReverse);
+        constexpr size_t childCount = Tree.nodes[Node].childCount;
+        constexpr size_t flow = flowCount(Node);
+        constexpr float flexGrow = totalFlexGrow(Node);
+
+        LayoutResult& layout = results[Node];
+        FlexState state;
+        state.contentWidth = std::max(0.0f, layout.width - layout.paddingLeft - layout.paddingRight);
+        state.contentHeight = std::max(0.0f, layout.height - layout.paddingTop - layout.paddingBottom);
+        state.mainAxisSize = column ? state.contentHeight : state.contentWidth;
+        state.crossAxisSize = column ? state.contentWidth : state.contentHeight;
+
+        bool crossAxisFromChildren = (state.crossAxisSize <= 0);
+
+        // Pass 1: base sizes of children in normal flow
+        [&]<size_t... K>(std::index_sequence<K...>) {
+            (measureChild<childIndex(Node, K), column>(results, state), ...);
+        }(std::make_index_sequence<childCount>{});
+
+        if constexpr (flow == 0) {
+            return;
+        } else {
+            float totalGap = style.gap * (flow - 1);
+
+            if (crossAxisFromChildren && state.maxChildCrossSize > 0) {
+                state.crossAxisSize = state.maxChildCrossSize;
+                if constexpr (column) {
+                    layout.width = state.crossAxisSize + layout.paddingLeft + layout.paddingRight;
+                    state.contentWidth = state.crossAxisSize;
+                } else {
+                    layout.height = state.crossAxisSize + layout.paddingTop + layout.paddingBottom;
+                    state.contentHeight = state.crossAxisSize;
+                }
+            }
+
+            float remainingSpace = state.mainAxisSize - state.totalFixedSize - totalGap;
+            if constexpr (flexGrow > 0) {
+                state.flexGrowUnit = remainingSpace > 0 ? remainingSpace / flexGrow : 0.0f;
+            }
+
+            state.mainOffset = column ? layout.paddingTop : layout.paddingLeft;
+            if constexpr (flexGrow == 0) {
+                float leadingSpace = 0.0f;
+                justifySpacing<style.justifyContent, flow>(remainingSpace, leadingSpace,
+                                                           state.interItemSpace);
+                state.mainOffset += leadingSpace;
+            }
+
+            // Pass 2: position children, in reverse order if needed
+            [&]<size_t... K>(std::index_sequence<K...>) {
+                (placeChild<Node, childIndex(Node, reverse ? childCount - 1 - K : K), column>(
+                    results, state), ...);
+            }(std::make_index_sequence<childCount>{});
+
+            float requiredMainSize = state.mainOffset - (column ? layout.paddingTop : layout.paddingLeft);
+
+            constexpr bool mainAxisNotDefined = column ? !style.height.isDefined()
+                                                       : !style.width.isDefined();
+            if constexpr (mainAxisNotDefined) {
+                if (requiredMainSize > 0) {
+                    if constexpr (column) {
+                        layout.height = requiredMainSize + layout.paddingTop + layout.paddingBottom;
+                    } else {
+                        layout.width = requiredMainSize + layout.paddingLeft + layout.paddingRight;
+                    }
+                }
+            }
+        }
+    }
+
+    template <size_t Child, bool Column>
+    static constexpr void measureChild(Results& results, FlexState& state) {
+        if constexpr (isInFlow(Child)) {
+            constexpr const Style& childStyle = Tree.nodes[Child].style;
+            constexpr const LayoutValue& mainSize = Column ? childStyle.height : childStyle.width;
+            constexpr const LayoutValue& crossSize = Column ? childStyle.width : childStyle.height;
+
+            float childMainSize = resolve<mainSize.unit>(
+                mainSize.value, Column ? state.contentHeight : state.contentWidth);
+            float childCrossSize = resolve<crossSize.unit>(
+                crossSize.value, Column ? state.contentWidth : state.contentHeight);
+
+            LayoutResult& childLayout = results[Child];
+            childLayout.width = Column ? childCrossSize : childMainSize;
+            childLayout.height = Column ? childMainSize : childCrossSize;
+
+            state.maxChildCrossSize = std::max(state.maxChildCrossSize, childCrossSize);
+            state.totalFixedSize += childMainSize;
+        }
+    }
+
+    template <size_t Node, size_t Child, bool Column>
+    static constexpr void placeChild(Results& results, FlexState& state) {
+        if constexpr (isInFlow(Child)) {
+            constexpr const Style& style = Tree.nodes[Node].style;
+            constexpr const Style& childStyle = Tree.nodes[Child].style;
+            constexpr AlignItems align = resolveAlignment(style.alignItems, childStyle.alignSelf);
+
+            const LayoutResult& layout = results[Node];
+            LayoutResult& childLayout = results[Child];
+
+            float childMainSize = Column ? childLayout.height : childLayout.width;
+            float childCrossSize = Column ? childLayout.width : childLayout.height;
+
+            if constexpr (childStyle.flexGrow > 0) {
+                if (state.flexGrowUnit > 0) {
+                    childMainSize += childStyle.flexGrow * state.flexGrowUnit;
+                }
+            }
+
+            // No cross size of its own: stretched or not, it spans the line
+            float finalCrossSize = (childCrossSize == 0) ? state.crossAxisSize : childCrossSize;
+
+            float crossOffset = Column ? layout.paddingLeft : layout.paddingTop;
+            if constexpr (align == AlignItems::FlexEnd) {
+                crossOffset += state.crossAxisSize - finalCrossSize;
+            } else if constexpr (align == AlignItems::Center) {
+                crossOffset += (state.crossAxisSize - finalCrossSize) / 2.0f;
+            }
+
+            if constexpr (Column) {
+                childLayout.left = crossOffset;
+                childLayout.top = state.mainOffset;
+                childLayout.width = finalCrossSize;
+                childLayout.height = childMainSize;
+            } else {
+                childLayout.left = state.mainOffset;
+                childLayout.top = crossOffset;
+                childLayout.width = childMainSize;
+                childLayout.height = finalCrossSize;
+            }
+
+            if constexpr (Tree.nodes[Child].childCount > 0) {
+                layoutFlexContainer<Child>(results);
+
+                float actualChildMainSize = Column ? childLayout.height : childLayout.width;
+                if (actualChildMainSize != childMainSize) {
+                    state.mainOffset += (actualChildMainSize - childMainSize);
+                    childMainSize = actualChildMainSize;
+                }
+            }
+
+            state.mainOffset += childMainSize + style.gap;
+            constexpr size_t flow = flowCount(Node);
+            if (++state.flowIndex < flow) {
+                state.mainOffset += state.interItemSpace;
+            }
+        }
+    }
+
+    // Space before the first child and between children when none grows
+    template <JustifyContent Justify, size_t ChildCount>
+    static constexpr void justifySpacing(float remainingSpace,
+                                         float& leadingSpace, float& interItemSpace) {
+        if (remainingSpace <= 0) return;
+
+        if constexpr (Justify == JustifyContent::FlexEnd) {
+            leadingSpace = remainingSpace;
+        } else if constexpr (Justify == JustifyContent::Center) {
+            leadingSpace = remainingSpace / 2.0f;
+        } else if constexpr (Justify == JustifyContent::SpaceBetween) {
+            if constexpr (ChildCount > 1) {
+                interItemSpace = remainingSpace / (ChildCount - 1);
+            }
+        } else if constexpr (Justify == JustifyContent::SpaceAround) {
+            leadingSpace = remainingSpace / (ChildCount * 2);
+            if constexpr (ChildCount > 1) {
+                interItemSpace = remainingSpace / ChildCount;
+            }
+        } else if constexpr (Justify == JustifyContent::SpaceEvenly) {
+            leadingSpace = remainingSpace / (ChildCount + 1);
+            if constexpr (ChildCount > 1) {
+                interItemSpace = remainingSpace / (ChildCount + 1);
+            }
+        }
+    }
+
+    // Absolutely positioned children of the root, framed from their style
+    static constexpr void layoutAbsoluteChildren(Results& results) {
+        [&]<size_t... K>(std::index_sequence<K...>) {
+            (placeAbsoluteChild<childIndex(0, K)>(results), ...);
+        }(std::make_index_sequence<Tree.nodes[0].childCount>{});
+    }
+
+    template <size_t Child>
+    static constexpr void placeAbsoluteChild(Results& results) {
+        if constexpr (!isInFlow(Child)) {
+            constexpr const Style& childStyle = Tree.nodes[Child].style;
+            const LayoutResult& layout = results[0];
+            LayoutResult& childLayout = results[Child];
+
+            constexpr const LayoutValue* position = childStyle.position;
+
+            float width = resolve<childStyle.width.unit>(childStyle.width.value, layout.width);
+            float height = resolve<childStyle.height.unit>(childStyle.height.value, layout.height);
+
+            float left = 0.0f;
+            if constexpr (position[0].isDefined()) {
+                left = resolve<position[0].unit>(position[0].value, layout.width);
+            } else if constexpr (position[2].isDefined()) {
+                left = layout.width - width - resolve<position[2].unit>(position[2].value, layout.width);
+            }
+
+            float top = 0.0f;
+            if constexpr (position[1].isDefined()) {
+                top = resolve<position[1].unit>(position[1].value, layout.height);
+            } else if constexpr (position[3].isDefined()) {
+                top = layout.height - height - resolve<position[3].unit>(position[3].value, layout.height);
+            }
+
+            childLayout.left = left;
+            childLayout.top = top;
+            childLayout.width = width;
+            childLayout.height = height;
+
+            if constexpr (Tree.nodes[Child].childCount > 0) {
+                layoutFlexContainer<Child>(results);
+            }
+        }
+    }
+};
+
+} // namespace obsidian::layout
@@ -3,6 +3,12 @@
  */
 
 #include "style.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace obsidian::layout {
 
@@ -77,4 +83,321 @@ LayoutValue Style::getPosition(Edge edge) const {
     return position[idx];
 }
 
+// Interned grid track lists; index = id - 1
+//
+// Readers don't lock: lists are appended into blocks that never move
+// and published through `count`. Block b holds kFirstBlock << b lists,
+// so kBlockCount blocks cover every id a CompactStyle can store (2^24).
+struct GridTrackTable {
+    static constexpr size_t kFirstBlock = 16;
+    static constexpr size_t kBlockCount = 21;
+
+    std::atomic<std::span<const GridTrack>*> blocks[kBlockCount] = {};
+    std::atomic<uint32_t> count{0};
+
+    // Writers only
+    std::mutex mutex;
+    std::unordered_multimap<size_t, uint32_t> ids;  // By hashTracks()
+
+    // Block and slot of a list index
+    static size_t block(size_t index) {
+        return static_cast<size_t>(std::bit_width((index + kFirstBlock) / kFirstBlock)) - 1;
+    }
+    static size_t slot(size_t index, size_t block) {
+        return index + kFirstBlock - (kFirstBlock << block);
+    }
+};
+
+static GridTrackTable& gridTrackTable() {
+    static auto* table = new GridTrackTable();
+    return *table;
+}
+
+static size_t hashTracks(std::span<const GridTrack> tracks) {
+    size_t hash = 14695981039346656037ull;
+    for (const GridTrack& track : tracks) {
+        // +0 and -0 compare equal, so they must hash alike
+        float value = track.value == 0.0f ? 0.0f : track.value;
+        hash = (hash ^ static_cast<uint32_t>(track.type)) * 1099511628211ull;
+        hash = (hash ^ std::bit_cast<uint32_t>(value)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+GridTracks::GridTracks(std::initializer_list<GridTrack> tracks)
+    : GridTracks(std::span<const GridTrack>(tracks.begin(), tracks.size())) {
+}
+
+GridTracks::GridTracks(std::span<const GridTrack> tracks) {
+    if (tracks.empty()) return;
+
+    GridTrackTable& table = gridTrackTable();
+    size_t hash = hashTracks(tracks);
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto [first, last] = table.ids.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        std::span<const GridTrack> existing = fromId(it->second).tracks();
+        if (std::equal(tracks.begin(), tracks.end(), existing.begin(), existing.end())) {
+            id_ = it->second;
+            return;
+        }
+    }
+
+    uint32_t index = table.count.load(std::memory_order_relaxed);
+    size_t block = GridTrackTable::block(index);
+    if (block >= GridTrackTable::kBlockCount) return;  // Out of ids: no tracks
+
+    std::span<const GridTrack>* lists = table.blocks[block].load(std::memory_order_relaxed);
+    if (!lists) {
+        lists = new std::span<const GridTrack>[GridTrackTable::kFirstBlock << block];
+        table.blocks[block].store(lists, std::memory_order_relaxed);
+    }
+    // Kept for the whole program, like the table
+    auto* copy = new GridTrack[tracks.size()];
+    std::copy(tracks.begin(), tracks.end(), copy);
+    lists[GridTrackTable::slot(index, block)] = {copy, tracks.size()};
+
+    // Publish: a reader that sees the count sees the list
+    table.count.store(index + 1, std::memory_order_release);
+    table.ids.emplace(hash, index + 1);
+    id_ = index + 1;
+}
+
+std::span<const GridTrack> GridTracks::tracks() const {
+    if (id_ == 0) return {};
+
+    GridTrackTable& table = gridTrackTable();
+    if (id_ > table.count.load(std::memory_order_acquire)) return {};
+
+    size_t index = id_ - 1;
+    size_t block = GridTrackTable::block(index);
+    return table.blocks[block].load(std::memory_order_relaxed)[GridTrackTable::slot(index, block)];
+}
+
+GridTracks GridTracks::fromId(uint32_t id) {
+    GridTracks tracks;
+    tracks.id_ = id;
+    return tracks;
+}
+
+// Number of StyleProperty slots holding LayoutValues; floats follow,
+// then the grid properties, which are integers
+static constexpr size_t kLayoutValueCount = static_cast<size_t>(StyleProperty::FlexGrow);
+static constexpr size_t kFloatEnd = static_cast<size_t>(StyleProperty::GridColumns);
+
+// LayoutValue slot of a property below kLayoutValueCount
+template <typename S>
+static auto& layoutValueSlot(S& style, size_t property) {
+    switch (property) {
+        case 0: return style.flexBasis;
+        case 1: case 2: case 3: case 4: return style.position[property - 1];
+        case 5: return style.width;
+        case 6: return style.height;
+        case 7: return style.minWidth;
+        case 8: return style.minHeight;
+        case 9: return style.maxWidth;
+        case 10: return style.maxHeight;
+        case 11: case 12: case 13: case 14: return style.padding[property - 11];
+        default: return style.margin[property - 15];
+    }
+}
+
+// Float slot of a property in [kLayoutValueCount, kFloatEnd)
+template <typename S>
+static auto& floatSlot(S& style, size_t property) {
+    switch (static_cast<StyleProperty>(property)) {
+        case StyleProperty::FlexGrow: return style.flexGrow;
+        case StyleProperty::FlexShrink: return style.flexShrink;
+        case StyleProperty::Gap: return style.gap;
+        default: return style.aspectRatio;
+    }
+}
+
+// Value of a grid property at or above kFloatEnd
+static uint32_t gridValue(const Style& style, size_t property) {
+    switch (static_cast<StyleProperty>(property)) {
+        case StyleProperty::GridColumns: return style.gridColumns.getId();
+        case StyleProperty::GridRows: return style.gridRows.getId();
+        case StyleProperty::GridColumn: return style.gridColumn;
+        case StyleProperty::GridRow: return style.gridRow;
+        case StyleProperty::GridColumnSpan: return style.gridColumnSpan;
+        default: return style.gridRowSpan;
+    }
+}
+
+static void setGridValue(Style& style, size_t property, uint32_t value) {
+    switch (static_cast<StyleProperty>(property)) {
+        case StyleProperty::GridColumns: style.gridColumns = GridTracks::fromId(value); break;
+        case StyleProperty::GridRows: style.gridRows = GridTracks::fromId(value); break;
+        case StyleProperty::GridColumn: style.gridColumn = static_cast<uint16_t>(value); break;
+        case StyleProperty::GridRow: style.gridRow = static_cast<uint16_t>(value); break;
+        case StyleProperty::GridColumnSpan: style.gridColumnSpan = static_cast<uint16_t>(value); break;
+        default: style.gridRowSpan = static_cast<uint16_t>(value); break;
+    }
+}
+
+CompactStyle CompactStyle::encode(const Style& style, float* values) {
+    static const Style defaults;
+
+    CompactStyle compact;
+    compact.enums_ = static_cast<uint16_t>(
+        static_cast<uint32_t>(style.flexDirection) << kDirectionShift |
+        static_cast<uint32_t>(style.justifyContent) << kJustifyShift |
+        static_cast<uint32_t>(style.alignItems) << kAlignItemsShift |
+        static_cast<uint32_t>(style.alignSelf) << kAlignSelfShift |
+        static_cast<uint32_t>(style.positionType) << kPositionShift |
+        static_cast<uint32_t>(style.display) << kDisplayShift);
+
+    size_t count = 0;
+    for (size_t property = 0; property < kLayoutValueCount; ++property) {
+        const LayoutValue& value = layoutValueSlot(style, property);
+        if (value.isUndefined()) continue;
+
+        compact.present_ |= 1u << property;
+        if (value.unit == Unit::Percent) {
+            compact.percent_ |= 1u << property;
+        }
+        values[count++] = value.value;
+    }
+    for (size_t property = kLayoutValueCount; property < kFloatEnd; ++property) {
+        float value = floatSlot(style, property);
+        // Bitwise compare so that NaN and -0 survive the round trip
+        if (std::bit_cast<uint32_t>(value) == std::bit_cast<uint32_t>(floatSlot(defaults, property))) continue;
+
+        compact.present_ |= 1u << property;
+        values[count++] = value;
+    }
+    for (size_t property = kFloatEnd; property < kStylePropertyCount; ++property) {
+        uint32_t value = gridValue(style, property);
+        if (value == gridValue(defaults, property)) continue;
+
+        // Exact as a float: track list ids and indices stay below 2^24
+        compact.present_ |= 1u << property;
+        values[count++] = static_cast<float>(value);
+    }
+    return compact;
+}
+
+Style CompactStyle::decode(const float* values) const {
+    Style style;
+    style.flexDirection = getFlexDirection();
+    style.justifyContent = getJustifyContent();
+    style.alignItems = getAlignItems();
+    style.alignSelf = getAlignSelf();
+    style.positionType = getPositionType();
+    style.display = getDisplay();
+
+    // Visit set properties only, in storage order
+    for (uint32_t remaining = present_; remaining != 0; remaining &= remaining - 1) {
+        auto property = static_cast<size_t>(std::countr_zero(remaining));
+        float value = *values++;
+
+        if (property < kLayoutValueCount) {
+            Unit unit = (percent_ & (1u << property)) ? Unit::Percent : Unit::Point;
+            layoutValueSlot(style, property) = LayoutValue{value, unit};
+        } else if (property < kFloatEnd) {
+            floatSlot(style, property) = value;
+        } else {
+            setGridValue(style, property, static_cast<uint32_t>(value));
+        }
+    }
+    return style;
+}
+
+// Interned styles by hash; entries are removed by the last owner
+struct InternedStyle {
+    const Style* style;
+    std::weak_ptr<const Style> ref;
+};
+
+struct StyleTable {
+    std::mutex mutex;
+    std::unordered_multimap<size_t, InternedStyle> entries;
+};
+
+static StyleTable& styleTable() {
+    // Never destroyed: styles may be released during static teardown
+    static auto* table = new StyleTable();
+    return *table;
+}
+
+static size_t hashStyle(const Style& style) {
+    size_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint32_t bits) {
+        hash = (hash ^ bits) * 1099511628211ull;
+    };
+    auto mixValue = [&mix](const LayoutValue& value) {
+        mix(std::bit_cast<uint32_t>(value.value));
+        mix(static_cast<uint32_t>(value.unit));
+    };
+
+    mix(static_cast<uint32_t>(style.flexDirection));
+    mix(static_cast<uint32_t>(style.justifyContent));
+    mix(static_cast<uint32_t>(style.alignItems));
+    mix(static_cast<uint32_t>(style.alignSelf));
+    mix(static_cast<uint32_t>(style.positionType));
+    mix(static_cast<uint32_t>(style.display));
+    for (size_t property = 0; property < kLayoutValueCount; ++property) {
+        mixValue(layoutValueSlot(style, property));
+    }
+    for (size_t property = kLayoutValueCount; property < kFloatEnd; ++property) {
+        mix(std::bit_cast<uint32_t>(floatSlot(style, property)));
+    }
+    for (size_t property = kFloatEnd; property < kStylePropertyCount; ++property) {
+        mix(gridValue(style, property));
+    }
+    return hash;
+}
+
+// Deleter of interned styles
+struct ReleaseInternedStyle {
+    size_t hash;
+
+    void operator()(const Style* style) const {
+        StyleTable& table = styleTable();
+        {
+            std::lock_guard<std::mutex> lock(table.mutex);
+            auto range = table.entries.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.style == style) {
+                    table.entries.erase(it);
+                    break;
+                }
+            }
+        }
+        delete style;
+    }
+};
+
+SharedStyle StyleInterner::intern(const Style& style) {
+    size_t hash = hashStyle(style);
+    StyleTable& table = styleTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto range = table.entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        // The entry outlives its style until the deleter takes the lock
+        if (*it->second.style == style) {
+            if (SharedStyle shared = it->second.ref.lock()) {
+                return shared;
+            }
+        }
+    }
+
+    SharedStyle shared(new Style(style), ReleaseInternedStyle{hash});
+    table.entries.emplace(hash, InternedStyle{shared.get(), shared});
+    return shared;
+}
+
+const SharedStyle& StyleInterner::defaultStyle() {
+    static const SharedStyle style = intern(Style{});
+    return style;
+}
+
+size_t StyleInterner::size() {
+    StyleTable& table = styleTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.entries.size();
+}
+
 } // namespace obsidian::layout
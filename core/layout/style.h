@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <limits>
+#include <memory>
+#include <span>
 
 namespace obsidian::layout {
 
@@ -28,22 +33,32 @@ struct LayoutValue {
     float value = 0.0f;
     Unit unit = Unit::Undefined;
     
-    static LayoutValue undefined() { return {0.0f, Unit::Undefined}; }
-    static LayoutValue points(float v) { return {v, Unit::Point}; }
-    static LayoutValue percent(float v) { return {v, Unit::Percent}; }
-    static LayoutValue auto_() { return undefined(); }
+    static constexpr LayoutValue undefined() { return {0.0f, Unit::Undefined}; }
+    static constexpr LayoutValue points(float v) { return {v, Unit::Point}; }
+    static constexpr LayoutValue percent(float v) { return {v, Unit::Percent}; }
+    static constexpr LayoutValue auto_() { return undefined(); }
     
-    bool isUndefined() const { return unit == Unit::Undefined; }
-    bool isDefined() const { return unit != Unit::Undefined; }
+    constexpr bool isUndefined() const { return unit == Unit::Undefined; }
+    constexpr bool isDefined() const { return unit != Unit::Undefined; }
+    
+    bool operator==(const LayoutValue& other) const = default;
     
     // Resolve to points given parent size
-    float resolve(float parentSize) const {
+    constexpr float resolve(float parentSize) const {
         if (unit == Unit::Point) return value;
         if (unit == Unit::Percent) return value * parentSize / 100.0f;
         return 0.0f;  // Undefined resolves to 0
     }
 };
 
+/**
+ * Display - which layout algorithm places the children
+ */
+enum class Display {
+    Flex,           // Flexbox along flexDirection (default)
+    Grid            // Rows and columns of gridColumns x gridRows tracks
+};
+
 /**
  * Flex direction - how children are laid out
  */
@@ -95,6 +110,62 @@ enum class PositionType {
     Absolute        // Removed from flow, positioned relative to parent
 };
 
+/**
+ * Grid track sizing
+ */
+enum class GridTrackType : uint8_t {
+    Auto,           // Size of the largest item in the track (default)
+    Fixed,          // Fixed size in points
+    Fraction        // Share of the space left after fixed and auto tracks
+};
+
+/**
+ * Grid track - one column or row of a grid container
+ */
+struct GridTrack {
+    GridTrackType type = GridTrackType::Auto;
+    float value = 0.0f;
+    
+    static constexpr GridTrack auto_() { return {GridTrackType::Auto, 0.0f}; }
+    static constexpr GridTrack points(float v) { return {GridTrackType::Fixed, v}; }
+    static constexpr GridTrack fraction(float v) { return {GridTrackType::Fraction, v}; }
+    
+    bool operator==(const GridTrack& other) const = default;
+};
+
+/**
+ * Grid track list
+ * 
+ * A handle to an interned, immutable list of tracks, so Styles stay
+ * small and cheap to copy, compare and hash. Equal lists share one
+ * handle. Lists are kept for the whole program; an application has
+ * only a handful of distinct grid templates. Thread-safe; reading a
+ * list takes no lock, so tracks() is cheap during parallel layout.
+ */
+class GridTracks {
+public:
+    constexpr GridTracks() = default;
+    GridTracks(std::initializer_list<GridTrack> tracks);
+    explicit GridTracks(std::span<const GridTrack> tracks);
+    
+    /**
+     * The tracks (empty for a default-constructed list)
+     */
+    std::span<const GridTrack> tracks() const;
+    
+    size_t size() const { return tracks().size(); }
+    bool empty() const { return id_ == 0; }
+    
+    // Interned list id, 0 for the empty list
+    uint32_t getId() const { return id_; }
+    static GridTracks fromId(uint32_t id);
+    
+    bool operator==(const GridTracks& other) const = default;
+    
+private:
+    uint32_t id_ = 0;
+};
+
 /**
  * Edge indices for padding/margin/border
  */
@@ -116,6 +187,9 @@ enum class Edge {
  * Modeled after Yoga's style system but simplified for our needs.
  */
 struct Style {
+    // Layout mode of the children
+    Display display = Display::Flex;
+    
     // Flex container properties
     FlexDirection flexDirection = FlexDirection::Column;
     JustifyContent justifyContent = JustifyContent::FlexStart;
@@ -127,6 +201,16 @@ struct Style {
     float flexShrink = 1.0f;    // How much this item shrinks when needed
     LayoutValue flexBasis = LayoutValue::auto_();  // Base size before flex
     
+    // Grid container properties (display == Grid)
+    GridTracks gridColumns;        // None: a single auto column
+    GridTracks gridRows;           // Rows past these are auto
+    
+    // Grid item properties (1-based track, 0 = next free cell)
+    uint16_t gridColumn = 0;
+    uint16_t gridRow = 0;
+    uint16_t gridColumnSpan = 1;
+    uint16_t gridRowSpan = 1;
+    
     // Position
     PositionType positionType = PositionType::Relative;
     LayoutValue position[4] = {};  // left, top, right, bottom
@@ -155,6 +239,138 @@ struct Style {
     LayoutValue getMargin(Edge edge) const;
     LayoutValue getPadding(Edge edge) const;
     LayoutValue getPosition(Edge edge) const;
+    
+    bool operator==(const Style& other) const = default;
+};
+
+/**
+ * Shared, immutable style
+ */
+using SharedStyle = std::shared_ptr<const Style>;
+
+/**
+ * Style interning
+ * 
+ * Keeps one shared instance per distinct style value, so nodes with
+ * equal styles point at the same object and compare equal by pointer.
+ * An instance is freed when its last reference goes away. Thread-safe.
+ */
+class StyleInterner {
+public:
+    /**
+     * Shared instance equal to `style`
+     */
+    static SharedStyle intern(const Style& style);
+    
+    /**
+     * Shared default Style{}, kept alive for the whole program
+     */
+    static const SharedStyle& defaultStyle();
+    
+    /**
+     * Number of distinct styles currently interned
+     */
+    static size_t size();
+};
+
+/**
+ * Numeric style properties, in compact storage order
+ */
+enum class StyleProperty : uint8_t {
+    FlexBasis,
+    PositionLeft, PositionTop, PositionRight, PositionBottom,
+    Width, Height, MinWidth, MinHeight, MaxWidth, MaxHeight,
+    PaddingLeft, PaddingTop, PaddingRight, PaddingBottom,
+    MarginLeft, MarginTop, MarginRight, MarginBottom,
+    FlexGrow, FlexShrink, Gap, AspectRatio,
+    GridColumns, GridRows, GridColumn, GridRow, GridColumnSpan, GridRowSpan,
+    Count
+};
+
+constexpr size_t kStylePropertyCount = static_cast<size_t>(StyleProperty::Count);
+
+/**
+ * Compact style encoding
+ * 
+ * A Style packed for bulk storage. The enums share one bit-packed word,
+ * and only properties that differ from the Style defaults are kept:
+ * a presence bitmask marks which properties are set, a second mask
+ * which of them are percentages. The set values themselves are stored
+ * by the owner, one float each in StyleProperty order (see LayoutTree).
+ * 
+ * Undefined LayoutValues are not stored, so decoding one yields
+ * LayoutValue::undefined() whatever number it held.
+ */
+class CompactStyle {
+public:
+    CompactStyle() = default;
+    
+    /**
+     * Encode a style, writing its set values to `values`
+     * (room for kStylePropertyCount floats)
+     */
+    static CompactStyle encode(const Style& style, float* values);
+    
+    /**
+     * Expand back into a full Style, reading the set values from `values`
+     */
+    Style decode(const float* values) const;
+    
+    // Number of stored values
+    size_t getValueCount() const { return static_cast<size_t>(std::popcount(present_)); }
+    
+    bool isSet(StyleProperty property) const {
+        return (present_ & (1u << static_cast<uint32_t>(property))) != 0;
+    }
+    
+    // Enum properties, read without decoding
+    FlexDirection getFlexDirection() const { return static_cast<FlexDirection>(field(kDirectionShift, 2)); }
+    JustifyContent getJustifyContent() const { return static_cast<JustifyContent>(field(kJustifyShift, 3)); }
+    AlignItems getAlignItems() const { return static_cast<AlignItems>(field(kAlignItemsShift, 2)); }
+    AlignSelf getAlignSelf() const { return static_cast<AlignSelf>(field(kAlignSelfShift, 3)); }
+    PositionType getPositionType() const { return static_cast<PositionType>(field(kPositionShift, 1)); }
+    Display getDisplay() const { return static_cast<Display>(field(kDisplayShift, 1)); }
+    
+    /**
+     * One value, read without decoding the rest; `values` are the
+     * ones the style was encoded with. Unset values read as undefined.
+     */
+    LayoutValue getLayoutValue(StyleProperty property, const float* values) const {
+        uint32_t bit = 1u << static_cast<uint32_t>(property);
+        if ((present_ & bit) == 0) return LayoutValue::undefined();
+        return LayoutValue{values[valueIndex(bit)], (percent_ & bit) ? Unit::Percent : Unit::Point};
+    }
+    
+    // Plain float property (FlexGrow..AspectRatio); `unset` when not set
+    float getFloat(StyleProperty property, const float* values, float unset) const {
+        uint32_t bit = 1u << static_cast<uint32_t>(property);
+        return (present_ & bit) ? values[valueIndex(bit)] : unset;
+    }
+    
+private:
+    // Bit offsets of the enums in enums_
+    static constexpr uint32_t kDirectionShift = 0;   // 2 bits
+    static constexpr uint32_t kJustifyShift = 2;     // 3 bits
+    static constexpr uint32_t kAlignItemsShift = 5;  // 2 bits
+    static constexpr uint32_t kAlignSelfShift = 7;   // 3 bits
+    static constexpr uint32_t kPositionShift = 10;   // 1 bit
+    static constexpr uint32_t kDisplayShift = 11;    // 1 bit
+    
+    static constexpr uint16_t kDefaultEnums =
+        static_cast<uint16_t>(static_cast<uint32_t>(AlignItems::Stretch) << kAlignItemsShift);
+    
+    uint32_t field(uint32_t shift, uint32_t bits) const {
+        return (enums_ >> shift) & ((1u << bits) - 1);
+    }
+    
+    // Values are stored in property order, one per set property
+    size_t valueIndex(uint32_t bit) const {
+        return static_cast<size_t>(std::popcount(present_ & (bit - 1)));
+    }
+    
+    uint32_t present_ = 0;  // Bit per StyleProperty: value differs from default
+    uint32_t percent_ = 0;  // Bit per StyleProperty: value is a percentage
+    uint16_t enums_ = kDefaultEnums;
 };
 
 } // namespace obsidian::layout
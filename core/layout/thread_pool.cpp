@@ -0,0 +1,119 @@
+/**
+ * Obsidian Layout Engine - Layout Thread Pool Implementation
+ */
+
+#include "thread_pool.h"
+
+namespace obsidian::layout {
+
+// Worker identity of the current thread
+static thread_local const LayoutThreadPool* workerPool = nullptr;
+static thread_local size_t workerIndex = 0;
+
+size_t LayoutThreadPool::defaultThreadCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+LayoutThreadPool::LayoutThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = 1;
+
+    for (size_t i = 0; i <= threadCount; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+LayoutThreadPool::~LayoutThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+size_t LayoutThreadPool::currentQueueIndex() const {
+    // Outside threads share the last queue
+    return workerPool == this ? workerIndex : threads_.size();
+}
+
+void LayoutThreadPool::run(TaskGroup& group, Task task) {
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+
+    Queue& queue = *queues_[currentQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.emplace_back(std::move(task), &group);
+    }
+    queuedCount_.fetch_add(1, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_one();
+}
+
+void LayoutThreadPool::wait(TaskGroup& group) {
+    size_t self = currentQueueIndex();
+    while (group.pending_.load(std::memory_order_acquire) > 0) {
+        if (!runOne(self)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool LayoutThreadPool::runOne(size_t queueIndex) {
+    std::pair<Task, TaskGroup*> item;
+    bool found = false;
+
+    // Own queue first, newest task (LIFO)
+    {
+        Queue& own = *queues_[queueIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            item = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    // Steal the oldest task from another queue (FIFO)
+    for (size_t i = 1; !found && i < queues_.size(); ++i) {
+        Queue& victim = *queues_[(queueIndex + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            item = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+
+    queuedCount_.fetch_sub(1, std::memory_order_relaxed);
+    item.first();
+    item.second->pending_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void LayoutThreadPool::workerLoop(size_t index) {
+    workerPool = this;
+    workerIndex = index;
+
+    while (true) {
+        if (runOne(index)) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] {
+            return stopping_ || queuedCount_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_) return;
+    }
+}
+
+} // namespace obsidian::layout
@@ -0,0 +1,92 @@
+/**
+ * Obsidian Layout Engine - Layout Thread Pool
+ *
+ * Work-stealing thread pool used to lay out independent subtrees
+ * concurrently. Each worker owns a deque: it pushes and pops its own
+ * tasks LIFO (depth-first, cache-warm) and steals from the front of
+ * other workers' deques when it runs dry.
+ *
+ * Tasks are grouped with a TaskGroup; waiting on a group runs pending
+ * tasks on the waiting thread, so nested fork/join never deadlocks.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace obsidian::layout {
+
+class LayoutThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * Set of tasks that can be waited on together
+     */
+    class TaskGroup {
+    public:
+        TaskGroup() = default;
+
+    private:
+        friend class LayoutThreadPool;
+        std::atomic<size_t> pending_{0};
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+    };
+
+    /**
+     * @param threadCount Number of worker threads (the calling thread
+     *                    also runs tasks while it waits)
+     */
+    explicit LayoutThreadPool(size_t threadCount = defaultThreadCount());
+    ~LayoutThreadPool();
+
+    size_t getThreadCount() const { return threads_.size(); }
+
+    /**
+     * Queue a task as part of a group
+     */
+    void run(TaskGroup& group, Task task);
+
+    /**
+     * Block until every task of the group has finished,
+     * running queued tasks on this thread in the meantime
+     */
+    void wait(TaskGroup& group);
+
+    static size_t defaultThreadCount();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::pair<Task, TaskGroup*>> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool runOne(size_t queueIndex);
+    size_t currentQueueIndex() const;
+
+    // One queue per worker, plus a shared queue for outside threads
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queuedCount_{0};
+    bool stopping_ = false;
+
+    // Non-copyable
+    LayoutThreadPool(const LayoutThreadPool&) = delete;
+    LayoutThreadPool& operator=(const LayoutThreadPool&) = delete;
+};
+
+} // namespace obsidian::layout
@@ -7,23 +7,32 @@
 namespace obsidian::layout {
 
 ViewNode::SetFrameCallback ViewNode::setFrameCallback_ = nullptr;
+ApplyFramesFunc ViewNode::applyFramesCallback_ = nullptr;
+FrameBuffer ViewNode::frameBuffer_;
+
+ViewNode* ViewNode::allocate() {
+    if (ViewNodePool* pool = ViewNodePool::current()) {
+        return pool->create();
+    }
+    return new ViewNode();
+}
 
 ViewNode* ViewNode::createContainer(FlexDirection direction, void* nativeView) {
-    auto* node = new ViewNode();
+    auto* node = allocate();
     node->getStyle().flexDirection = direction;
     node->setNativeView(nativeView);
     return node;
 }
 
 ViewNode* ViewNode::createSpacer(void* nativeView) {
-    auto* node = new ViewNode();
+    auto* node = allocate();
     node->getStyle().flexGrow = 1.0f;  // Spacers fill available space
     node->setNativeView(nativeView);
     return node;
 }
 
 ViewNode* ViewNode::createLeaf(void* nativeView, MeasureFunc measureFunc) {
-    auto* node = new ViewNode();
+    auto* node = allocate();
     node->setNativeView(nativeView);
     if (measureFunc) {
         node->setMeasureFunc(std::move(measureFunc));
@@ -31,6 +40,44 @@ ViewNode* ViewNode::createLeaf(void* nativeView, MeasureFunc measureFunc) {
     return node;
 }
 
+ViewNode* ViewNode::createLeaf(void* nativeView, const MeasureProvider* provider, void* context) {
+    auto* node = allocate();
+    node->setNativeView(nativeView);
+    node->setMeasureProvider(provider, context);
+    return node;
+}
+
+void ViewNode::destroy(ViewNode* node) {
+    if (!node) return;
+    
+    node->destroyChildren();
+    
+    if (node->arena_) {
+        ViewNodePool::release(node);
+    } else {
+        delete node;
+    }
+}
+
+void ViewNode::destroyChildren() {
+    // Detach all children at once rather than one removeChild per child
+    std::vector<LayoutNode*> children = getChildren();
+    removeAllChildren();
+    for (auto* child : children) {
+        auto* viewChild = static_cast<ViewNode*>(child);
+        if (viewChild->ownedByParent_) {
+            destroy(viewChild);
+        }
+    }
+}
+
+void ViewNode::adoptChild(ViewNode* child) {
+    if (!child) return;
+    
+    child->ownedByParent_ = true;
+    addChild(child);
+}
+
 void ViewNode::configureAsVStack(float spacing, float paddingTop, float paddingBottom,
                                   float paddingLeading, float paddingTrailing) {
     auto& style = getStyle();
@@ -40,7 +87,7 @@ void ViewNode::configureAsVStack(float spacing, float paddingTop, float paddingB
     style.padding[1] = LayoutValue::points(paddingTop);
     style.padding[2] = LayoutValue::points(paddingTrailing);
     style.padding[3] = LayoutValue::points(paddingBottom);
-    markDirty();
+    markDirty(DirtyReason::StyleChanged);
 }
 
 void ViewNode::configureAsHStack(float spacing, float paddingTop, float paddingBottom,
@@ -52,7 +99,7 @@ void ViewNode::configureAsHStack(float spacing, float paddingTop, float paddingB
     style.padding[1] = LayoutValue::points(paddingTop);
     style.padding[2] = LayoutValue::points(paddingTrailing);
     style.padding[3] = LayoutValue::points(paddingBottom);
-    markDirty();
+    markDirty(DirtyReason::StyleChanged);
 }
 
 void ViewNode::configureAsSpacer(float minWidth, float minHeight) {
@@ -64,16 +111,21 @@ void ViewNode::configureAsSpacer(float minWidth, float minHeight) {
     if (minHeight > 0) {
         style.minHeight = LayoutValue::points(minHeight);
     }
-    markDirty();
+    markDirty(DirtyReason::StyleChanged);
 }
 
 void ViewNode::layoutAndApply(float width, float height) {
     // Calculate layout
     calculateLayout(width, height);
     
-    // Apply to native views
-    if (setFrameCallback_) {
-        LayoutEngine::applyLayout(this, setFrameCallback_);
+    // Apply the changed frames to native views
+    if (!setFrameCallback_ && !applyFramesCallback_) return;
+    
+    frameBuffer_.collectChanges(this);
+    if (applyFramesCallback_) {
+        frameBuffer_.apply(applyFramesCallback_);
+    } else {
+        frameBuffer_.apply(setFrameCallback_);
     }
 }
 
@@ -81,4 +133,8 @@ void ViewNode::setSetFrameCallback(SetFrameCallback callback) {
     setFrameCallback_ = callback;
 }
 
+void ViewNode::setApplyFramesCallback(ApplyFramesFunc callback) {
+    applyFramesCallback_ = callback;
+}
+
 } // namespace obsidian::layout
@@ -9,6 +9,8 @@
 
 #include "node.h"
 #include "engine.h"
+#include "frame_buffer.h"
+#include "node_pool.h"
 
 namespace obsidian::layout {
 
@@ -17,6 +19,16 @@ namespace obsidian::layout {
  * 
  * This is used by UI components (VStack, HStack, etc.) to 
  * integrate with the layout engine.
+ * 
+ * Factories allocate from the current ViewNodePool when one is in scope,
+ * otherwise from the heap. Release nodes with destroy(), never delete.
+ * A ViewNode's descendants are expected to be ViewNodes as well.
+ * 
+ * Every node has one owner. A component owns the node it created for
+ * itself; a node added with adoptChild(), or handed over with
+ * setOwnedByParent() when its component goes away, is owned by its
+ * parent and freed with it. Nodes whose component is still alive are
+ * only detached, never freed, by their parent.
  */
 class ViewNode : public LayoutNode {
 public:
@@ -37,6 +49,31 @@ public:
      * Requires a measure function
      */
     static ViewNode* createLeaf(void* nativeView, MeasureFunc measureFunc);
+    static ViewNode* createLeaf(void* nativeView, const MeasureProvider* provider, void* context);
+    
+    /**
+     * Destroy a node and the children it owns, recursively
+     * Detaches the node from its parent and returns pooled nodes to
+     * their pool; heap-allocated nodes are deleted. Children owned by a
+     * component are detached and left to it.
+     */
+    static void destroy(ViewNode* node);
+    
+    /**
+     * Detach all children, destroying the ones this node owns
+     */
+    void destroyChildren();
+    
+    /**
+     * Add a child this node owns from now on
+     */
+    void adoptChild(ViewNode* child);
+    
+    /**
+     * Whether the parent owns this node, rather than a component
+     */
+    void setOwnedByParent(bool owned) { ownedByParent_ = owned; }
+    bool isOwnedByParent() const { return ownedByParent_; }
     
     /**
      * Configure as VStack (Column)
@@ -57,7 +94,8 @@ public:
     
     /**
      * Calculate layout and apply to native views
-     * Call this on the root node
+     * Call this on the root node. Only views whose frame changed since
+     * it was last applied are set.
      */
     void layoutAndApply(float width, float height);
     
@@ -66,9 +104,28 @@ public:
      */
     using SetFrameCallback = void(*)(void* view, float x, float y, float w, float h);
     static void setSetFrameCallback(SetFrameCallback callback);
+    
+    /**
+     * Set a callback that sets the changed frames of a pass in one call
+     * Takes precedence over the per-view SetFrameCallback.
+     */
+    static void setApplyFramesCallback(ApplyFramesFunc callback);
 
 private:
+    friend class ViewNodePool;
+    
+    // Allocate from the current pool, or the heap outside a pool scope
+    static ViewNode* allocate();
+    
     static SetFrameCallback setFrameCallback_;
+    static ApplyFramesFunc applyFramesCallback_;
+    static FrameBuffer frameBuffer_;
+    
+    // Pool memory holding this node (nullptr if heap-allocated)
+    ViewNodePool::Arena* arena_ = nullptr;
+    
+    // Freed by the parent's destroy() rather than by a component
+    bool ownedByParent_ = false;
 };
 
 } // namespace obsidian::layout
@@ -6,6 +6,7 @@
 #include "obsidian/navigation/router.h"
 #include "obsidian/window.h"
 #include "obsidian/navigation/screen_container.h"
+#include "core/layout/node_pool.h"
 #include <iostream>
 #include <sstream>
 
@@ -15,6 +16,9 @@ class RouteRenderer::Impl {
 public:
     std::map<std::string, RouteComponentFunction> routeComponents;
     std::map<std::string, LayoutComponentFunction> layoutComponents;
+    
+    // Layout nodes built while rendering a screen live in that screen's pool
+    std::map<std::string, std::unique_ptr<layout::ViewNodePool>> nodePools;
 };
 
 RouteRenderer::RouteRenderer() : pImpl(std::make_unique<Impl>()) {}
@@ -105,6 +109,15 @@ bool RouteRenderer::renderRoute(const RouteNode* routeNode,
         std::cerr << "[RouteRenderer] WARNING: No screenContainer!" << std::endl;
     }
     
+    // Allocate this render's layout nodes from the screen's pool. The
+    // previous content's components free their own nodes when destroyed,
+    // and their slots are reused.
+    auto& nodePool = pImpl->nodePools[routePath];
+    if (!nodePool) {
+        nodePool = std::make_unique<layout::ViewNodePool>();
+    }
+    layout::ViewNodePool::Scope nodePoolScope(*nodePool);
+    
     // Render into screen
     bool result = renderRouteWithLayouts(routeNode, window, screen, router, params, query, "");
     std::cerr << "[RouteRenderer] renderRouteWithLayouts returned: " << (result ? "SUCCESS" : "FAILED") << std::endl;
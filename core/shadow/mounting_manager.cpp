@@ -16,6 +16,11 @@ void MountingManager::setSetFrameFunc(SetFrameFunc func) {
     setFrameFunc_ = std::move(func);
 }
 
+void MountingManager::setViewHierarchyFuncs(InsertViewFunc insertView, RemoveViewFunc removeView) {
+    insertViewFunc_ = std::move(insertView);
+    removeViewFunc_ = std::move(removeView);
+}
+
 void MountingManager::applyMutations(const MutationList& mutations) {
     for (const auto& mutation : mutations) {
         applyMutation(mutation);
@@ -35,13 +40,19 @@ void MountingManager::applyMutation(const ViewMutation& mutation) {
             break;
             
         case MutationType::Insert:
-            // Native view insertion is handled by UI components
-            // This mutation is informational
+            // Native view insertion is handled by UI components,
+            // unless the platform mounts views itself
+            if (mutation.nativeView && insertViewFunc_) {
+                insertViewFunc_(mutation.nativeView, mutation.parentView, mutation.index);
+            }
             break;
             
         case MutationType::Remove:
-            // Native view removal is handled by UI components
-            // This mutation is informational
+            // Native view removal is handled by UI components,
+            // unless the platform mounts views itself
+            if (mutation.nativeView && removeViewFunc_) {
+                removeViewFunc_(mutation.nativeView, mutation.parentView);
+            }
             break;
             
         case MutationType::Update:
@@ -26,6 +26,15 @@ namespace obsidian::shadow {
  */
 using SetFrameFunc = std::function<void(void* nativeView, float x, float y, float width, float height)>;
 
+/**
+ * Callbacks to add a native view to a parent view, or take it out
+ * @param nativeView The native view handle
+ * @param parentView The parent view handle (nullptr for the surface's root view)
+ * @param index Position among the parent's subviews (Insert only)
+ */
+using InsertViewFunc = std::function<void(void* nativeView, void* parentView, size_t index)>;
+using RemoveViewFunc = std::function<void(void* nativeView, void* parentView)>;
+
 /**
  * Mounting Manager
  * 
@@ -42,6 +51,15 @@ public:
      */
     void setSetFrameFunc(SetFrameFunc func);
     
+    /**
+     * Set the platform-specific view insertion and removal.
+     * Optional: without them, Insert and Remove mutations are informational
+     * and UI components keep their views in place themselves. Set them to
+     * mount trees with view flattening on (ShadowTree::setViewFlattening),
+     * where views skip layout-only containers.
+     */
+    void setViewHierarchyFuncs(InsertViewFunc insertView, RemoveViewFunc removeView);
+    
     /**
      * Apply a list of mutations to native views.
      * Called by ShadowTree after commit().
@@ -58,6 +76,8 @@ private:
     ~MountingManager() = default;
     
     SetFrameFunc setFrameFunc_;
+    InsertViewFunc insertViewFunc_;
+    RemoveViewFunc removeViewFunc_;
     
     // Singleton
     MountingManager(const MountingManager&) = delete;
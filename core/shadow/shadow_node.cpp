@@ -46,11 +46,15 @@ ShadowNode::~ShadowNode() {
     if (parent_) {
         parent_->removeChild(this);
     }
+    untrackDetached();
     
     // Clear children's parent reference
     for (auto* child : children_) {
         child->parent_ = nullptr;
     }
+    for (auto* child : detachedChildren_) {
+        child->detachedFrom_ = nullptr;
+    }
 }
 
 void ShadowNode::setLayoutMetrics(const LayoutMetrics& metrics) {
@@ -70,13 +74,16 @@ void ShadowNode::addChild(ShadowNode* child) {
     }
     
     // Add to this node
+    child->untrackDetached();
+    child->indexInParent_ = children_.size();
     children_.push_back(child);
     child->parent_ = this;
     
     // Add to layout tree
     layoutNode_->addChild(child->layoutNode_.get());
     
-    markDirty();
+    flagDirty();
+    markMountingChanged();
 }
 
 void ShadowNode::insertChild(ShadowNode* child, size_t index) {
@@ -90,49 +97,188 @@ void ShadowNode::insertChild(ShadowNode* child, size_t index) {
     }
     
     // Insert at position
-    if (index >= children_.size()) {
-        children_.push_back(child);
-    } else {
-        children_.insert(children_.begin() + index, child);
-    }
+    child->untrackDetached();
+    index = std::min(index, children_.size());
+    children_.insert(children_.begin() + index, child);
     child->parent_ = this;
+    reindexChildren(index);
     
     // Insert into layout tree
     layoutNode_->insertChild(child->layoutNode_.get(), index);
     
-    markDirty();
+    flagDirty();
+    markMountingChanged();
 }
 
 void ShadowNode::removeChild(ShadowNode* child) {
-    if (!child) {
+    if (!child || child->parent_ != this) {
         return;
     }
     
-    auto it = std::find(children_.begin(), children_.end(), child);
-    if (it != children_.end()) {
-        children_.erase(it);
-        child->parent_ = nullptr;
-        
-        // Remove from layout tree
-        layoutNode_->removeChild(child->layoutNode_.get());
-        
-        markDirty();
-    }
+    // The child knows its index; no search needed
+    size_t index = child->indexInParent_;
+    children_.erase(children_.begin() + index);
+    child->parent_ = nullptr;
+    reindexChildren(index);
+    trackDetached(child);
+    
+    // Remove from layout tree
+    layoutNode_->removeChild(child->layoutNode_.get());
+    
+    flagDirty();
+    markMountingChanged();
 }
 
 void ShadowNode::removeAllChildren() {
     for (auto* child : children_) {
         child->parent_ = nullptr;
+        trackDetached(child);
     }
     children_.clear();
     layoutNode_->removeAllChildren();
-    markDirty();
+    flagDirty();
+    markMountingChanged();
+}
+
+void ShadowNode::setChildren(std::span<ShadowNode* const> children) {
+    replaceChildren(0, children_.size(), children);
+}
+
+void ShadowNode::replaceChildren(size_t first, size_t count, std::span<ShadowNode* const> children) {
+    first = std::min(first, children_.size());
+    count = std::min(count, children_.size() - first);
+    
+    // Detach the replaced range and claim the incoming children
+    for (size_t i = first; i < first + count; ++i) {
+        children_[i]->parent_ = nullptr;
+    }
+    for (auto* child : children) {
+        if (!child) continue;
+        if (child->parent_ == this) {
+            child->parent_ = nullptr;
+        } else if (child->parent_) {
+            child->parent_->removeChild(child);
+        }
+    }
+    
+    std::vector<ShadowNode*> result;
+    result.reserve(children_.size() - count + children.size());
+    auto keep = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (children_[i]->parent_ == this) result.push_back(children_[i]);
+        }
+    };
+    keep(0, first);
+    size_t insertAt = result.size();
+    keep(first + count, children_.size());
+    size_t keptCount = result.size();
+    for (auto* child : children) {
+        if (!child || child->parent_ == this) continue;  // Listed twice
+        child->untrackDetached();
+        child->parent_ = this;
+        result.push_back(child);
+    }
+    std::rotate(result.begin() + insertAt, result.begin() + keptCount, result.end());
+    
+    for (auto* child : children_) {
+        if (child->parent_ != this) trackDetached(child);
+    }
+    children_ = std::move(result);
+    reindexChildren(0);
+    
+    // Mirror the whole list into the layout tree in one step
+    std::vector<layout::LayoutNode*> layoutChildren;
+    layoutChildren.reserve(children_.size());
+    for (auto* child : children_) {
+        layoutChildren.push_back(child->layoutNode_.get());
+    }
+    layoutNode_->setChildren(layoutChildren);
+    
+    flagDirty();
+    markMountingChanged();
+}
+
+void ShadowNode::setNativeView(void* view) {
+    if (view == nativeView_) return;
+    
+    nativeView_ = view;
+    layoutNode_->setNativeView(view);
+    markMountingChanged();
+}
+
+void ShadowNode::setLayoutOnly(bool layoutOnly) {
+    if (layoutOnly == layoutOnly_) return;
+    
+    layoutOnly_ = layoutOnly;
+    markMountingChanged();
+}
+
+void ShadowNode::setViewTraits(const ViewTraits& traits) {
+    if (traits == viewTraits_) return;
+    
+    viewTraits_ = traits;
+    markMountingChanged();
+}
+
+bool ShadowNode::hasPlainStackView() const {
+    switch (componentType_) {
+        case ComponentType::VStack:
+        case ComponentType::HStack:
+        case ComponentType::ZStack:
+        case ComponentType::Spacer:
+            return !viewTraits_.any();
+        default:
+            return false;
+    }
+}
+
+void ShadowNode::markMountingChanged() {
+    for (ShadowNode* node = this; node && !node->mountingChanged_; node = node->parent_) {
+        node->mountingChanged_ = true;
+    }
+}
+
+void ShadowNode::trackDetached(ShadowNode* child) {
+    // Only children placed by a commit can have mounted views
+    if (!child->host_ || child->detachedFrom_) return;
+    
+    child->detachedFrom_ = this;
+    detachedChildren_.push_back(child);
+}
+
+void ShadowNode::untrackDetached() {
+    if (!detachedFrom_) return;
+    
+    auto& detached = detachedFrom_->detachedChildren_;
+    detached.erase(std::find(detached.begin(), detached.end(), this));
+    detachedFrom_ = nullptr;
+}
+
+void ShadowNode::reindexChildren(size_t from) {
+    for (size_t i = from; i < children_.size(); ++i) {
+        children_[i]->indexInParent_ = i;
+    }
 }
 
 size_t ShadowNode::getChildCount() const {
     return children_.size();
 }
 
+ShadowNode* ShadowNode::nextInPreOrder(const ShadowNode* root, bool descend) const {
+    if (descend && !children_.empty()) {
+        return children_.front();
+    }
+    
+    // Next sibling of the nearest ancestor (up to root) that has one
+    for (const ShadowNode* node = this; node != root && node->parent_; node = node->parent_) {
+        const std::vector<ShadowNode*>& siblings = node->parent_->children_;
+        if (node->indexInParent_ + 1 < siblings.size()) {
+            return siblings[node->indexInParent_ + 1];
+        }
+    }
+    return nullptr;
+}
+
 ShadowNode* ShadowNode::getChild(size_t index) const {
     if (index >= children_.size()) {
         return nullptr;
@@ -140,21 +286,28 @@ ShadowNode* ShadowNode::getChild(size_t index) const {
     return children_[index];
 }
 
-void ShadowNode::markDirty() {
-    if (isDirty_) {
-        return;  // Already dirty
-    }
-    
-    isDirty_ = true;
-    layoutNode_->markDirty();
-    
-    // Propagate to parent
-    if (parent_) {
-        parent_->markDirty();
+void ShadowNode::markDirty(layout::DirtyReason reason) {
+    // Always forwarded: isDirty_ may only mean that a descendant below a
+    // relayout boundary changed, with this node's layout still clean.
+    // The layout node propagates its own dirtiness, stopping at relayout boundaries.
+    layoutNode_->markDirty(reason);
+    flagDirty();
+}
+
+void ShadowNode::flagDirty() {
+    // Ancestors only record that something below them needs layout
+    for (ShadowNode* node = this; node && !node->isDirty_; node = node->parent_) {
+        node->isDirty_ = true;
     }
 }
 
 void ShadowNode::updateFromLayoutResult() {
+    for (ShadowNode* node = this; node; node = node->nextInPreOrder(this)) {
+        node->updateOwnLayoutMetrics();
+    }
+}
+
+void ShadowNode::updateOwnLayoutMetrics() {
     const auto& result = layoutNode_->getLayout();
     
     LayoutMetrics newMetrics;
@@ -169,11 +322,6 @@ void ShadowNode::updateFromLayoutResult() {
     
     setLayoutMetrics(newMetrics);
     clearDirty();
-    
-    // Update children
-    for (auto* child : children_) {
-        child->updateFromLayoutResult();
-    }
 }
 
 } // namespace obsidian::shadow
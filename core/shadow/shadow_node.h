@@ -18,6 +18,7 @@
 #include "../layout/style.h"
 #include "../layout/node.h"
 #include <memory>
+#include <span>
 #include <string>
 #include <cstdint>
 
@@ -80,6 +81,23 @@ enum class ComponentType {
     Custom      // User-defined component
 };
 
+/**
+ * What a node's native view draws or handles itself.
+ * A stack with none of these exists only for layout.
+ */
+struct ViewTraits {
+    bool hasBackground = false;
+    bool hasBorder = false;
+    bool handlesEvents = false;
+    bool clipsContent = false;
+    
+    bool any() const {
+        return hasBackground || hasBorder || handlesEvents || clipsContent;
+    }
+    
+    bool operator==(const ViewTraits& other) const = default;
+};
+
 /**
  * Shadow Node
  * 
@@ -114,32 +132,78 @@ public:
     void removeChild(ShadowNode* child);
     void removeAllChildren();
     
+    // Bulk changes, marking this node dirty once (see LayoutNode::replaceChildren)
+    void setChildren(std::span<ShadowNode* const> children);
+    void replaceChildren(size_t first, size_t count, std::span<ShadowNode* const> children);
+    
     size_t getChildCount() const;
     ShadowNode* getChild(size_t index) const;
     const std::vector<ShadowNode*>& getChildren() const { return children_; }
     
     // Parent
     ShadowNode* getParent() const { return parent_; }
+    size_t getIndexInParent() const { return indexInParent_; }
+    
+    // Next node of a pre-order walk over the subtree of `root`, without a
+    // stack (see LayoutNode::nextInPreOrder)
+    ShadowNode* nextInPreOrder(const ShadowNode* root, bool descend = true) const;
     
     // Native view association
-    void setNativeView(void* view) { nativeView_ = view; layoutNode_->setNativeView(view); }
+    void setNativeView(void* view);
     void* getNativeView() const { return nativeView_; }
     
+    // View flattening (see ShadowTree::isFlattened)
+    // A component marks its node layout-only when the node has no view of
+    // its own in the native hierarchy: its children's views are mounted
+    // into the nearest ancestor that has one, with the offsets of the
+    // flattened nodes in between added to their frames. View traits say
+    // what a stack's view does, for trees that flatten stacks themselves.
+    void setLayoutOnly(bool layoutOnly);
+    bool isLayoutOnly() const { return layoutOnly_; }
+    void setViewTraits(const ViewTraits& traits);
+    const ViewTraits& getViewTraits() const { return viewTraits_; }
+    
+    // Node whose native view this node's view was mounted in by the last
+    // commit (nullptr for the root, or if flattened)
+    ShadowNode* getMountedParent() const { return mountedView_ ? host_ : nullptr; }
+    
     // Layout node (internal - for layout engine)
     layout::LayoutNode* getLayoutNode() { return layoutNode_.get(); }
     const layout::LayoutNode* getLayoutNode() const { return layoutNode_.get(); }
     
     // Dirty tracking
-    void markDirty();
+    // The reason is recorded for ShadowTree::getLastInvalidations()
+    void markDirty(layout::DirtyReason reason = layout::DirtyReason::Explicit);
     bool isDirty() const { return isDirty_; }
     void clearDirty() { isDirty_ = false; }
     
-    // Update layout metrics from computed layout
+    // Update layout metrics of this subtree from computed layout
     void updateFromLayoutResult();
 
 private:
     friend class ShadowTree;
     
+    // Refresh indexInParent_ of the children from `from` on
+    void reindexChildren(size_t from);
+    
+    // Copy this node's own computed layout into its metrics
+    void updateOwnLayoutMetrics();
+    
+    // Flag this node and its ancestors dirty, after a change its layout
+    // node already propagated (children changed)
+    void flagDirty();
+    
+    // Children, native view or traits changed: flag the path to the root,
+    // so the next commit revisits how this subtree is mounted
+    void markMountingChanged();
+    
+    // Stack or spacer whose view draws and handles nothing (no view traits)
+    bool hasPlainStackView() const;
+    
+    // Remember a removed child, whose mounted views the next commit removes
+    void trackDetached(ShadowNode* child);
+    void untrackDetached();
+    
     ShadowTag tag_;
     ComponentType componentType_;
     
@@ -153,6 +217,7 @@ private:
     // Tree structure
     ShadowNode* parent_ = nullptr;
     std::vector<ShadowNode*> children_;
+    size_t indexInParent_ = 0;  // Valid while parent_ is set
     
     // Native view (for applying layout)
     void* nativeView_ = nullptr;
@@ -161,6 +226,24 @@ private:
     bool isDirty_ = true;
     bool layoutMetricsChanged_ = false;
     
+    // Mounting, as of the last commit
+    bool layoutOnly_ = false;
+    ViewTraits viewTraits_;
+    ShadowNode* host_ = nullptr;        // Nearest ancestor that isn't flattened
+    float hostX_ = 0.0f;                // This node's origin in host_ coordinates
+    float hostY_ = 0.0f;
+    LayoutMetrics mountedMetrics_;      // Frame last sent, in host_ coordinates
+    void* mountedView_ = nullptr;       // View inserted into the host's view
+    ShadowTag mountedInTag_ = 0;        // Host it was inserted into
+    void* mountedInView_ = nullptr;
+    size_t mountedChildCount_ = 0;      // Views placed in this one during a commit
+    bool remountChildren_ = false;      // Re-insert them all, in order
+    bool mountingChanged_ = true;       // Set on the path to any mounting change
+    
+    // Removed children not yet unmounted by a commit
+    std::vector<ShadowNode*> detachedChildren_;
+    ShadowNode* detachedFrom_ = nullptr;
+    
     // Non-copyable
     ShadowNode(const ShadowNode&) = delete;
     ShadowNode& operator=(const ShadowNode&) = delete;
@@ -31,7 +31,8 @@ ViewMutation ViewMutation::createDelete(ShadowTag tag, void* nativeView) {
     return m;
 }
 
-ViewMutation ViewMutation::createInsert(ShadowTag tag, ShadowTag parentTag, size_t index, void* nativeView) {
+ViewMutation ViewMutation::createInsert(ShadowTag tag, ShadowTag parentTag, size_t index, void* nativeView,
+                                        void* parentView) {
     ViewMutation m;
     m.type = MutationType::Insert;
     m.tag = tag;
@@ -39,10 +40,12 @@ ViewMutation ViewMutation::createInsert(ShadowTag tag, ShadowTag parentTag, size
     m.index = index;
     m.componentType = ComponentType::Custom;
     m.nativeView = nativeView;
+    m.parentView = parentView;
     return m;
 }
 
-ViewMutation ViewMutation::createRemove(ShadowTag tag, ShadowTag parentTag, void* nativeView) {
+ViewMutation ViewMutation::createRemove(ShadowTag tag, ShadowTag parentTag, void* nativeView,
+                                        void* parentView) {
     ViewMutation m;
     m.type = MutationType::Remove;
     m.tag = tag;
@@ -50,6 +53,7 @@ ViewMutation ViewMutation::createRemove(ShadowTag tag, ShadowTag parentTag, void
     m.index = 0;
     m.componentType = ComponentType::Custom;
     m.nativeView = nativeView;
+    m.parentView = parentView;
     return m;
 }
 
@@ -139,11 +143,36 @@ void ShadowTree::deleteNode(ShadowTag tag) {
     
     auto it = nodes_.find(tag);
     if (it != nodes_.end()) {
+        // Views of the subtree may sit in a host above it; nothing would
+        // remove them once the nodes are gone
+        unmountSubtree(it->second.get(), pendingRemovals_);
+        
         // TODO: Generate Delete mutations for this node and children
         nodes_.erase(it);
     }
 }
 
+void ShadowTree::setViewFlattening(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled == viewFlattening_) return;
+    
+    viewFlattening_ = enabled;
+    if (rootNode_) {
+        rootNode_->markMountingChanged();
+    }
+}
+
+bool ShadowTree::isFlattened(const ShadowNode* node) const {
+    if (!node->getParent()) {
+        return false;
+    }
+    if (!viewFlattening_) {
+        // Children of a node with a view live in it until the platform moves them
+        return node->isLayoutOnly() && !node->getNativeView();
+    }
+    return node->isLayoutOnly() || !node->getNativeView() || node->hasPlainStackView();
+}
+
 void ShadowTree::setMountingCallback(MountingCallback callback) {
     std::lock_guard<std::mutex> lock(mutex_);
     mountingCallback_ = std::move(callback);
@@ -156,20 +185,46 @@ bool ShadowTree::commit(float width, float height) {
         return false;
     }
     
-    // Step 1: Calculate layout
-    // This computes layout for the entire tree starting from root
-    layout::LayoutEngine::calculateLayout(
-        rootNode_->getLayoutNode(),
-        width,
-        height
-    );
+    // Views of deleted nodes go first, with the other removals
+    MutationList mutations = std::move(pendingRemovals_);
+    pendingRemovals_.clear();
+    
+    // Step 1: Lay out just the dirty relayout boundaries when nothing above
+    // them changed. Their frames stay put, so only their subtrees change.
+    std::vector<ShadowNode*> boundaries;
+    bool boundariesOnly = (width == committedWidth_ && height == committedHeight_) &&
+                          collectDirtyBoundaries(rootNode_.get(), boundaries) &&
+                          !boundaries.empty();
+    for (auto* boundary : boundaries) {
+        if (!boundariesOnly) break;
+        boundariesOnly = layout::LayoutEngine::layoutBoundary(boundary->getLayoutNode());
+    }
     
-    // Step 2: Update layout metrics from computed layout
-    rootNode_->updateFromLayoutResult();
+    if (boundariesOnly) {
+        // Steps 2-3 for the laid out subtrees only
+        for (auto* boundary : boundaries) {
+            boundary->updateFromLayoutResult();
+            collectLayoutChanges(boundary, mutations);
+        }
+    } else {
+        // Otherwise compute layout for the entire tree starting from root
+        layout::LayoutEngine::calculateLayout(
+            rootNode_->getLayoutNode(),
+            width,
+            height
+        );
+        committedWidth_ = width;
+        committedHeight_ = height;
+        
+        // Step 2: Update layout metrics from computed layout
+        rootNode_->updateFromLayoutResult();
+        
+        // Step 3: Collect mutations for views with changed layout
+        collectLayoutChanges(rootNode_.get(), mutations);
+    }
     
-    // Step 3: Collect mutations for views with changed layout
-    MutationList mutations;
-    collectLayoutChanges(rootNode_.get(), mutations);
+    // Including those the engine made during this layout
+    collectInvalidations();
     
     // Step 4: Call mounting callback with mutations
     if (mountingCallback_ && !mutations.empty()) {
@@ -191,27 +246,176 @@ bool ShadowTree::isDirty() const {
     return rootNode_ && rootNode_->isDirty();
 }
 
-void ShadowTree::collectLayoutChanges(ShadowNode* node, MutationList& mutations) {
-    if (!node) {
+void ShadowTree::collectInvalidations() {
+    rootNode_->getLayoutNode()->takeInvalidations(layoutInvalidations_);
+    invalidations_.clear();
+    if (layoutInvalidations_.empty()) {
         return;
     }
     
-    // If layout changed and has a native view, generate Update mutation
-    if (node->layoutMetricsChanged_ && node->getNativeView()) {
-        mutations.push_back(
-            ViewMutation::createUpdate(
-                node->getTag(),
-                node->getLayoutMetrics(),
-                node->getNativeView()
-            )
-        );
+    // Find the shadow nodes of the recorded layout nodes in one walk
+    std::unordered_map<const layout::LayoutNode*, ShadowTag> tags;
+    for (const auto& invalidation : layoutInvalidations_) {
+        tags.emplace(invalidation.root, 0);
+        tags.emplace(invalidation.origin, 0);
+    }
+    for (ShadowNode* node = rootNode_.get(); node; node = node->nextInPreOrder(rootNode_.get())) {
+        auto it = tags.find(node->getLayoutNode());
+        if (it != tags.end()) {
+            it->second = node->getTag();
+        }
+    }
+    
+    for (const auto& invalidation : layoutInvalidations_) {
+        invalidations_.push_back({tags[invalidation.root], tags[invalidation.origin],
+                                  invalidation.reason, invalidation.count});
+    }
+}
+
+void ShadowTree::collectLayoutChanges(ShadowNode* root, MutationList& mutations) {
+    // Removals go out first, so Insert indices count only views that stay
+    MutationList placements;
+    
+    // A partial walk below a relayout boundary only runs without mounting
+    // changes; hosts above the boundary keep their flags from earlier walks
+    const bool fullWalk = !root->getParent();
+    
+    for (ShadowNode* node = root; node; node = node->nextInPreOrder(root)) {
+        // Views of subtrees removed from this node since the last commit
+        for (ShadowNode* detached : node->detachedChildren_) {
+            detached->detachedFrom_ = nullptr;
+            unmountSubtree(detached, mutations);
+        }
+        node->detachedChildren_.clear();
+        
+        // Position in the nearest view, accumulating the offsets of
+        // flattened ancestors. The root of a partial walk (a relayout
+        // boundary) kept its frame, so its position is still valid.
+        const LayoutMetrics& metrics = node->getLayoutMetrics();
+        ShadowNode* parent = node->getParent();
+        if (!parent) {
+            node->host_ = nullptr;
+            node->hostX_ = metrics.x;
+            node->hostY_ = metrics.y;
+        } else if (node != root) {
+            bool parentFlattened = isFlattened(parent);
+            node->host_ = parentFlattened ? parent->host_ : parent;
+            node->hostX_ = (parentFlattened ? parent->hostX_ : 0.0f) + metrics.x;
+            node->hostY_ = (parentFlattened ? parent->hostY_ : 0.0f) + metrics.y;
+        }
+        bool mountingChanged = node->mountingChanged_;
         node->layoutMetricsChanged_ = false;
+        node->mountingChanged_ = false;
+        
+        if (isFlattened(node)) {
+            if (node->mountedView_) {
+                mutations.push_back(ViewMutation::createRemove(
+                    node->getTag(), node->mountedInTag_, node->mountedView_, node->mountedInView_));
+                node->mountedView_ = nullptr;
+            }
+            continue;
+        }
+        
+        // Set before the walk reaches the views placed in this one. When
+        // anything below changed how views mount here, all of them are
+        // inserted again in order, so each Insert moves one into place.
+        node->remountChildren_ = mountingChanged;
+        node->mountedChildCount_ = 0;
+        
+        bool inserted = false;
+        if (ShadowNode* host = node->host_) {
+            bool moved = node->mountedView_ &&
+                         (node->mountedView_ != node->getNativeView() ||
+                          node->mountedInTag_ != host->getTag() ||
+                          node->mountedInView_ != host->getNativeView());
+            if (moved) {
+                mutations.push_back(ViewMutation::createRemove(
+                    node->getTag(), node->mountedInTag_, node->mountedView_, node->mountedInView_));
+                node->mountedView_ = nullptr;
+            }
+            // A node without a view (when not flattened) has nothing to insert
+            size_t index = host->mountedChildCount_;
+            if (node->getNativeView()) {
+                ++host->mountedChildCount_;
+            }
+            if (node->getNativeView() && (!node->mountedView_ || (fullWalk && host->remountChildren_))) {
+                placements.push_back(ViewMutation::createInsert(
+                    node->getTag(), host->getTag(), index, node->getNativeView(), host->getNativeView()));
+                node->mountedView_ = node->getNativeView();
+                node->mountedInTag_ = host->getTag();
+                node->mountedInView_ = host->getNativeView();
+                inserted = true;
+            }
+        }
+        
+        // Frame in the coordinates of the view it's mounted in
+        LayoutMetrics mounted = metrics;
+        mounted.x = node->hostX_;
+        mounted.y = node->hostY_;
+        if (node->getNativeView() && (inserted || mounted != node->mountedMetrics_)) {
+            placements.push_back(
+                ViewMutation::createUpdate(node->getTag(), mounted, node->getNativeView())
+            );
+        }
+        node->mountedMetrics_ = mounted;
+    }
+    
+    mutations.insert(mutations.end(), placements.begin(), placements.end());
+}
+
+void ShadowTree::unmountSubtree(ShadowNode* root, MutationList& removals) {
+    std::vector<ShadowNode*> subtrees{root};
+    while (!subtrees.empty()) {
+        ShadowNode* subtree = subtrees.back();
+        subtrees.pop_back();
+        
+        for (ShadowNode* node = subtree; node; node = node->nextInPreOrder(subtree)) {
+            if (node->mountedView_) {
+                removals.push_back(ViewMutation::createRemove(
+                    node->getTag(), node->mountedInTag_, node->mountedView_, node->mountedInView_));
+                node->mountedView_ = nullptr;
+            }
+            node->host_ = nullptr;
+            
+            // Removed from within the removed subtree
+            for (ShadowNode* detached : node->detachedChildren_) {
+                detached->detachedFrom_ = nullptr;
+                subtrees.push_back(detached);
+            }
+            node->detachedChildren_.clear();
+        }
+    }
+}
+
+bool ShadowTree::collectDirtyBoundaries(ShadowNode* root, std::vector<ShadowNode*>& boundaries) {
+    // Mounting changes move views between hosts; revisit the whole tree
+    if (root->getLayoutNode()->isDirty() || root->mountingChanged_) {
+        return false;
     }
+    root->clearDirty();
     
-    // Recurse to children
-    for (auto* child : node->getChildren()) {
-        collectLayoutChanges(child, mutations);
+    // Descend only through dirty shadow nodes whose layout node is clean
+    ShadowNode* node = root->nextInPreOrder(root);
+    while (node) {
+        if (!node->isDirty()) {
+            node = node->nextInPreOrder(root, false);
+            continue;
+        }
+        
+        const layout::LayoutNode* layoutNode = node->getLayoutNode();
+        if (layoutNode->isDirty()) {
+            // First dirty layout node on this path; dirtiness stopped here
+            if (!layoutNode->isRelayoutBoundary()) {
+                return false;
+            }
+            boundaries.push_back(node);
+            node = node->nextInPreOrder(root, false);
+        } else {
+            node->clearDirty();
+            node = node->nextInPreOrder(root);
+        }
     }
+    return true;
 }
 
 // ShadowTreeRegistry implementation
@@ -55,17 +55,32 @@ struct ViewMutation {
     ComponentType componentType;
     LayoutMetrics layoutMetrics;
     void* nativeView;           // Native view handle
+    void* parentView = nullptr; // For Insert/Remove; nullptr is the surface's root view
     
     // Factory methods
     static ViewMutation createCreate(ShadowTag tag, ComponentType type, void* nativeView);
     static ViewMutation createDelete(ShadowTag tag, void* nativeView);
-    static ViewMutation createInsert(ShadowTag tag, ShadowTag parentTag, size_t index, void* nativeView);
-    static ViewMutation createRemove(ShadowTag tag, ShadowTag parentTag, void* nativeView);
+    static ViewMutation createInsert(ShadowTag tag, ShadowTag parentTag, size_t index, void* nativeView,
+                                     void* parentView = nullptr);
+    static ViewMutation createRemove(ShadowTag tag, ShadowTag parentTag, void* nativeView,
+                                     void* parentView = nullptr);
     static ViewMutation createUpdate(ShadowTag tag, const LayoutMetrics& metrics, void* nativeView);
 };
 
 using MutationList = std::vector<ViewMutation>;
 
+/**
+ * A markDirty() that led to a commit, by the node it was called on and
+ * the node its dirtiness reached: the root, or a relayout boundary that
+ * absorbed it. Recorded with OBSIDIAN_LAYOUT_INVALIDATIONS.
+ */
+struct InvalidationRecord {
+    ShadowTag root = 0;
+    ShadowTag origin = 0;       // 0 if the node has left the tree since
+    layout::DirtyReason reason = layout::DirtyReason::Explicit;
+    uint32_t count = 0;         // Times since the previous commit
+};
+
 /**
  * Callback type for applying mutations to native views
  */
@@ -102,10 +117,32 @@ public:
     
     /**
      * Delete a node and all its children.
-     * Generates Delete mutations.
+     * Generates Delete mutations. Views of the subtree still mounted,
+     * including ones mounted in a host above it, get Remove mutations
+     * at the next commit.
      */
     void deleteNode(ShadowTag tag);
     
+    /**
+     * Also flatten nodes without a native view, and stacks and spacers
+     * whose views have no view traits. Their children's views then move
+     * out of those views, so turn this on only when the mounting callback
+     * applies Insert and Remove mutations (MountingManager with
+     * setViewHierarchyFuncs), and set the traits of every stack that
+     * draws or handles something. Off by default.
+     */
+    void setViewFlattening(bool enabled);
+    bool isViewFlattening() const { return viewFlattening_; }
+    
+    /**
+     * Whether a node's view is left out of the mounted hierarchy, its
+     * children's views mounting into the nearest ancestor's instead.
+     * Without view flattening, only layout-only nodes without a native
+     * view are; with it, also nodes without a native view and plain
+     * stacks and spacers (see setViewFlattening). Never the root.
+     */
+    bool isFlattened(const ShadowNode* node) const;
+    
     /**
      * Set the mounting callback.
      * Called with mutations after commit().
@@ -116,6 +153,14 @@ public:
      * Compute layout and generate mutations.
      * This is the main entry point - similar to React Native's commit().
      * 
+     * When the size is unchanged and all changes sit below relayout
+     * boundaries, only those boundaries are laid out and diffed.
+     * 
+     * Flattened nodes (see isFlattened) mount no view: their descendants'
+     * views get Insert mutations into the nearest ancestor view, and
+     * Update frames relative to it. All Remove mutations come first, then
+     * Inserts and Updates in tree order.
+     * 
      * @param width Available width for layout
      * @param height Available height for layout
      * @return true if layout was computed and mutations were generated
@@ -131,13 +176,30 @@ public:
      * Check if tree needs layout
      */
     bool isDirty() const;
+    
+    /**
+     * What invalidated the tree before the last commit, one record per
+     * node, target and reason. Empty unless built with
+     * OBSIDIAN_LAYOUT_INVALIDATIONS (--config=layout_invalidations).
+     */
+    const std::vector<InvalidationRecord>& getLastInvalidations() const { return invalidations_; }
 
 private:
     // Generate next unique tag
     ShadowTag generateTag();
     
-    // Collect nodes with changed layout metrics
-    void collectLayoutChanges(ShadowNode* node, MutationList& mutations);
+    // Collect mount changes and nodes with changed layout metrics
+    void collectLayoutChanges(ShadowNode* root, MutationList& mutations);
+    
+    // Remove the mounted views of a subtree taken out of the tree
+    void unmountSubtree(ShadowNode* root, MutationList& removals);
+    
+    // Collect dirty relayout boundaries below a node with clean layout.
+    // Returns false if some change needs a full layout pass.
+    bool collectDirtyBoundaries(ShadowNode* root, std::vector<ShadowNode*>& boundaries);
+    
+    // Take the invalidations recorded in the layout tree, by shadow tag
+    void collectInvalidations();
     
     SurfaceId surfaceId_;
     std::unique_ptr<ShadowNode> rootNode_;
@@ -151,6 +213,20 @@ private:
     // Mounting callback
     MountingCallback mountingCallback_;
     
+    // Flatten plain stacks and viewless nodes too
+    std::atomic<bool> viewFlattening_{false};
+    
+    // Removes for views of deleted nodes, sent with the next commit
+    MutationList pendingRemovals_;
+    
+    // Size of the last full layout pass
+    float committedWidth_ = -1.0f;
+    float committedHeight_ = -1.0f;
+    
+    // Invalidations of the last commit
+    std::vector<layout::Invalidation> layoutInvalidations_;
+    std::vector<InvalidationRecord> invalidations_;
+    
     // Thread safety
     mutable std::mutex mutex_;
     
@@ -201,13 +201,15 @@ public:
     
     /**
      * Release ownership of the layout node.
-     * After calling this, the HStack will not delete its layout node when destroyed.
-     * This is used when the layout node is adopted by a parent container.
+     * After calling this, the HStack will not delete its layout node when destroyed;
+     * whoever holds the node must free it with ViewNode::destroy().
      * 
-     * This implements the ownership transfer model inspired by React Native's Shadow Tree:
-     * - When HStack is added as child to VStack, VStack takes ownership of HStack's layoutNode
-     * - HStack's destructor won't delete the layoutNode (parent owns it now)
-     * - This ensures layout persists even when HStack object goes out of scope
+     * Not needed for nesting. The ownership model is inspired by React Native's Shadow Tree:
+     * - The HStack owns its layoutNode for as long as it exists; a parent container only
+     *   detaches it (e.g. in clearChildren()), so the HStack stays usable
+     * - If the HStack is destroyed while inside a container, the container's node takes
+     *   ownership and frees it with its own node
+     * - This ensures layout persists even when the HStack object goes out of scope
      */
     void releaseLayoutNodeOwnership();
     
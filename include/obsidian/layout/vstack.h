@@ -231,13 +231,15 @@ public:
     
     /**
      * Release ownership of the layout node.
-     * After calling this, the VStack will not delete its layout node when destroyed.
-     * This is used when the layout node is adopted by a parent container.
+     * After calling this, the VStack will not delete its layout node when destroyed;
+     * whoever holds the node must free it with ViewNode::destroy().
      * 
-     * This implements the ownership transfer model inspired by React Native's Shadow Tree:
-     * - When VStack is added as child to HStack/VStack, parent takes ownership of VStack's layoutNode
-     * - VStack's destructor won't delete the layoutNode (parent owns it now)
-     * - This ensures layout persists even when VStack object goes out of scope
+     * Not needed for nesting. The ownership model is inspired by React Native's Shadow Tree:
+     * - The VStack owns its layoutNode for as long as it exists; a parent container only
+     *   detaches it (e.g. in clearChildren()), so the VStack stays usable
+     * - If the VStack is destroyed while inside a container, the container's node takes
+     *   ownership and frees it with its own node
+     * - This ensures layout persists even when the VStack object goes out of scope
      */
     void releaseLayoutNodeOwnership();
     
@@ -10,10 +10,12 @@
 #ifdef __APPLE__
 
 #ifdef __cplusplus
+#include <cstddef>
 #include <cstdint>
 #include <cstdbool>
 extern "C" {
 #else
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #endif
@@ -54,6 +56,26 @@ void obsidian_macos_view_set_frame(void* viewHandle,
                                     double x, double y, 
                                     double width, double height);
 
+/**
+ * Frame of a view in a batch (same layout as obsidian::layout::ViewFrame)
+ */
+typedef struct ObsidianViewFrame {
+    void* view;
+    float x;
+    float y;
+    float width;
+    float height;
+} ObsidianViewFrame;
+
+/**
+ * Set the frames of many NSViews in one call
+ * Used by the Layout Engine to apply the frames that changed in a pass
+ * 
+ * @param frames Views and their frames, relative to their parents
+ * @param count Number of frames
+ */
+void obsidian_macos_view_set_frames(const ObsidianViewFrame* frames, size_t count);
+
 /**
  * Get bounds of any NSView
  * Returns the view's bounds rectangle
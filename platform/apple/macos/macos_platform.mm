@@ -119,6 +119,20 @@ void obsidian_macos_view_set_frame(void* viewHandle,
     }
 }
 
+void obsidian_macos_view_set_frames(const ObsidianViewFrame* frames, size_t count) {
+    if (!frames || count == 0) return;
+    
+    @autoreleasepool {
+        for (size_t i = 0; i < count; ++i) {
+            NSView* view = (__bridge NSView*)frames[i].view;
+            if (view) {
+                view.frame = NSMakeRect(frames[i].x, frames[i].y,
+                                        frames[i].width, frames[i].height);
+            }
+        }
+    }
+}
+
 void obsidian_macos_view_get_bounds(void* viewHandle,
                                      double* outX, double* outY,
                                      double* outWidth, double* outHeight) {
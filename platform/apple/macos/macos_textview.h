@@ -10,6 +10,7 @@
 #ifdef __APPLE__
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -0,0 +1,195 @@
+/**
+ * Obsidian Layout Benchmark - Deep Chains
+ *
+ * Lays out, applies and commits chains of nested containers, each the
+ * only child of the one above, ending in a measured leaf. Every traversal
+ * of the engine and the shadow tree is iterative, so the depth is limited
+ * only by memory; a recursive step anywhere overflows the stack long
+ * before 10k levels on a secondary thread.
+ *
+ * Usage: deep_chain_bench [depth] [iterations]
+ */
+
+#include "core/layout/engine.h"
+#include "core/layout/layout_tree.h"
+#include "core/layout/node.h"
+#include "core/shadow/shadow_node.h"
+#include "core/shadow/shadow_tree.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace obsidian;
+using namespace obsidian::layout;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Size measureLeaf(float /* width */, MeasureMode /* widthMode */,
+                 float /* height */, MeasureMode /* heightMode */) {
+    return {40.0f, 20.0f};
+}
+
+void setFrame(void* /* nativeView */, float /* x */, float /* y */,
+              float /* width */, float /* height */) {}
+
+Style containerStyle() {
+    Style style;
+    style.flexDirection = FlexDirection::Column;
+    return style;
+}
+
+template <typename Fn>
+double timeMs(size_t iterations, Fn&& fn) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+void report(const char* name, double ms) {
+    std::printf("  %-24s %10.3f ms\n", name, ms);
+}
+
+void benchNodeChain(size_t depth, size_t iterations) {
+    std::vector<std::unique_ptr<LayoutNode>> nodes;
+    nodes.reserve(depth + 1);
+    for (size_t i = 0; i <= depth; ++i) {
+        nodes.push_back(std::make_unique<LayoutNode>());
+        if (i < depth) {
+            nodes[i]->setStyle(containerStyle());
+        } else {
+            nodes[i]->setMeasureFunc(measureLeaf);
+        }
+        nodes[i]->setNativeView(nodes[i].get());
+    }
+
+    // Built bottom-up: attaching marks every ancestor dirty, so top-down
+    // construction would take quadratic time
+    for (size_t i = depth; i > 0; --i) {
+        nodes[i - 1]->addChild(nodes[i].get());
+    }
+    LayoutNode* root = nodes.front().get();
+    LayoutNode* leaf = nodes.back().get();
+
+    std::printf("LayoutNode chain, depth %zu\n", depth);
+    report("first layout", timeMs(1, [&] {
+        LayoutEngine::calculateLayout(root, 800.0f, 600.0f);
+    }));
+    // Without relayout boundaries, a dirty leaf dirties the whole chain
+    report("relayout from leaf", timeMs(iterations, [&] {
+        leaf->markDirty();
+        LayoutEngine::calculateLayout(root, 800.0f, 600.0f);
+    }));
+    report("clean layout", timeMs(iterations, [&] {
+        LayoutEngine::calculateLayout(root, 800.0f, 600.0f);
+    }));
+    report("apply", timeMs(iterations, [&] {
+        LayoutEngine::applyLayout(root, setFrame);
+    }));
+
+    const LayoutResult& layout = leaf->getLayout();
+    std::printf("  leaf frame               %.0f,%.0f %.0fx%.0f\n",
+                layout.left, layout.top, layout.width, layout.height);
+
+    // Detach top-down, so destroying the nodes doesn't dirty long chains
+    root->removeAllChildren();
+    for (size_t i = 1; i < depth; ++i) {
+        nodes[i]->removeAllChildren();
+    }
+}
+
+void benchTreeChain(size_t depth, size_t iterations) {
+    LayoutTree tree;
+    tree.reserve(depth + 1);
+    NodeId root = tree.createNode();
+    tree.setStyle(root, containerStyle());
+    NodeId parent = root;
+    for (size_t i = 1; i <= depth; ++i) {
+        NodeId node = tree.createNode();
+        if (i < depth) {
+            tree.setStyle(node, containerStyle());
+        } else {
+            tree.setMeasureFunc(node, measureLeaf);
+        }
+        tree.appendChild(parent, node);
+        parent = node;
+    }
+
+    std::printf("LayoutTree chain, depth %zu\n", depth);
+    report("layout", timeMs(iterations, [&] {
+        LayoutEngine::calculateLayout(tree, root, 800.0f, 600.0f);
+    }));
+    report("apply", timeMs(iterations, [&] {
+        LayoutEngine::applyLayout(tree, root, setFrame);
+    }));
+}
+
+void benchShadowChain(size_t depth, size_t iterations) {
+    shadow::ShadowTree tree(1);
+    tree.setViewFlattening(true);
+    std::vector<shadow::ShadowNode*> nodes;
+    nodes.reserve(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        // Stacks are flattened, so the leaf's view mounts in the root's
+        // with the offsets of the whole chain added up
+        auto type = (i + 1 < depth) ? shadow::ComponentType::VStack
+                                    : shadow::ComponentType::TextView;
+        shadow::ShadowNode* node = tree.createNode(type);
+        node->setNativeView(node);
+        node->getStyle() = containerStyle();
+        nodes.push_back(node);
+    }
+    for (size_t i = depth - 1; i > 0; --i) {
+        nodes[i - 1]->addChild(nodes[i]);
+    }
+    tree.getRootNode()->addChild(nodes.front());
+    shadow::ShadowNode* leaf = nodes.back();
+
+    size_t updates = 0;
+    tree.setMountingCallback([&](const shadow::MutationList& mutations) {
+        updates += mutations.size();
+    });
+
+    std::printf("ShadowTree chain, depth %zu\n", depth);
+
+    // Alternate sizes so every commit lays out and walks the whole chain
+    size_t round = 0;
+    report("commit (resize)", timeMs(iterations, [&] {
+        float width = (++round % 2) ? 800.0f : 640.0f;
+        tree.commit(width, 600.0f);
+    }));
+    report("commit (leaf dirty)", timeMs(iterations, [&] {
+        leaf->markDirty();
+        tree.commit(640.0f, 600.0f);
+    }));
+    std::printf("  mutations                %zu\n", updates);
+
+    // Detach top-down, so destroying the nodes doesn't dirty long chains
+    tree.getRootNode()->removeAllChildren();
+    for (shadow::ShadowNode* node : nodes) {
+        node->removeAllChildren();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t depth = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t iterations = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20;
+    if (depth == 0 || iterations == 0) {
+        std::fprintf(stderr, "usage: %s [depth] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    benchNodeChain(depth, iterations);
+    benchTreeChain(depth, iterations);
+    benchShadowChain(depth, iterations);
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * Obsidian Layout Benchmark - Recorded Trees
+ *
+ * Loads a tree captured with LayoutRecording (a real screen, say) and
+ * lays it out repeatedly at its recorded size, reporting latency
+ * percentiles. Leaves answer from their recorded sizes, so this runs
+ * anywhere, without native views or a text system.
+ *
+ * The first layout is checked against the recorded frames; any
+ * difference is reported and makes the exit status 2, so a set of
+ * recordings doubles as a layout regression test.
+ *
+ * Two kinds of pass are timed:
+ *   full      a freshly built tree, as after loading a screen
+ *   root      only the root dirty; the rest comes from the layout caches
+ *
+ * Usage: replay_bench <recording> [iterations]
+ */
+
+#include "core/layout/engine.h"
+#include "core/layout/layout_recording.h"
+#include "core/layout/node.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace obsidian;
+using namespace obsidian::layout;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Nearest-rank percentile of sorted samples
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.5);
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+void report(const char* name, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    std::printf("  %-8s p50 %10.1f  p90 %10.1f  p99 %10.1f  max %10.1f us\n", name,
+                percentile(samples, 50.0), percentile(samples, 90.0),
+                percentile(samples, 99.0), samples.back());
+}
+
+// Time `iterations` layouts of the root `prepare` returns, untimed, before each
+template <typename Prepare>
+std::vector<double> timeLayouts(float width, float height, size_t iterations, Prepare&& prepare) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        LayoutNode* root = prepare();
+        auto start = Clock::now();
+        LayoutEngine::calculateLayout(root, width, height);
+        std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    return samples;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 100;
+    if (argc < 2 || iterations == 0) {
+        std::fprintf(stderr, "usage: %s <recording> [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    LayoutRecording recording;
+    if (!recording.load(argv[1])) {
+        std::fprintf(stderr, "%s: not a valid layout recording\n", argv[1]);
+        return 1;
+    }
+    LayoutNode* root = recording.instantiate();
+    if (!root) {
+        std::fprintf(stderr, "%s: recording is empty\n", argv[1]);
+        return 1;
+    }
+    float width = recording.getAvailableWidth();
+    float height = recording.getAvailableHeight();
+
+    std::printf("%s: %zu nodes, %zu styles, %zu measurements, %.0fx%.0f\n", argv[1],
+                recording.getNodeCount(), recording.getStyleCount(),
+                recording.getMeasurementCount(), width, height);
+
+    LayoutEngine::calculateLayout(root, width, height);
+    size_t mismatches = recording.countMismatches();
+    if (mismatches > 0) {
+        std::printf("  %zu frames differ from the recording\n", mismatches);
+    }
+
+    std::vector<double> rootOnly = timeLayouts(width, height, iterations, [&] {
+        root->markDirty();
+        return root;
+    });
+    // Rebuilding is linear; dirtying every node would walk to the root from each
+    std::vector<double> full = timeLayouts(width, height, iterations, [&] {
+        return recording.instantiate();
+    });
+
+    std::printf("%zu iterations\n", iterations);
+    report("full", full);
+    report("root", rootOnly);
+    return mismatches > 0 ? 2 : 0;
+}
@@ -0,0 +1,265 @@
+/**
+ * Obsidian Layout Check - Batched Measurement
+ *
+ * Lays out the same tree with leaves measured one at a time, through
+ * LayoutOptions::batchMeasure, and through batchMeasure with a thread
+ * pool, and compares the frames. The measurer is plain C++ (a text
+ * stand-in that wraps at the width it is given), so this runs anywhere.
+ * Also counts the batch calls: one per round and kind of leaf, none once
+ * the measurements are cached, and one per MeasureProvider::measureBatch
+ * whether or not batchMeasure is set.
+ *
+ * Exits non-zero when a check fails.
+ */
+
+#include "core/layout/engine.h"
+#include "core/layout/node.h"
+#include "core/layout/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace obsidian::layout;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL %s\n", what);
+        ++failures;
+    }
+}
+
+void expect(bool condition, const char* what, size_t actual, size_t expected) {
+    if (!condition) {
+        std::printf("FAIL %s: %zu, expected %zu\n", what, actual, expected);
+        ++failures;
+    }
+}
+
+// Text stand-in: fixed-width glyphs, wrapping at an AtMost width
+struct Text {
+    float length = 0.0f;
+};
+
+Size textSize(const Text& text, float width, MeasureMode widthMode) {
+    constexpr float kGlyphWidth = 7.0f;
+    constexpr float kLineHeight = 16.0f;
+    float natural = text.length * kGlyphWidth;
+    if (widthMode == MeasureMode::Exactly) {
+        return {width, kLineHeight * std::ceil(natural / std::max(width, 1.0f))};
+    }
+    if (widthMode == MeasureMode::AtMost && natural > width) {
+        return {width, kLineHeight * std::ceil(natural / std::max(width, 1.0f))};
+    }
+    return {natural, kLineHeight};
+}
+
+Size measureText(void* context, float width, MeasureMode widthMode, float, MeasureMode) {
+    return textSize(*static_cast<const Text*>(context), width, widthMode);
+}
+
+const MeasureProvider kTextProvider{measureText, nullptr, nullptr};
+
+// Icons measure themselves in batches, with or without batchMeasure
+std::atomic<size_t> iconBatchCalls{0};
+std::atomic<size_t> iconRequests{0};
+
+Size measureIcon(void*, float, MeasureMode, float, MeasureMode) {
+    return {24.0f, 24.0f};
+}
+
+void measureIcons(MeasureRequest* requests, size_t count) {
+    iconBatchCalls.fetch_add(1, std::memory_order_relaxed);
+    iconRequests.fetch_add(count, std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        requests[i].result = measureIcon(nullptr, 0.0f, MeasureMode::Undefined,
+                                         0.0f, MeasureMode::Undefined);
+    }
+}
+
+const MeasureProvider kIconProvider{measureIcon, measureIcons, nullptr};
+
+// Counting batch measurer for text leaves
+struct TextBatcher {
+    std::atomic<size_t> calls{0};
+    std::atomic<size_t> requests{0};
+
+    BatchMeasureFunc func() {
+        return [this](MeasureRequest* batch, size_t count) {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            requests.fetch_add(count, std::memory_order_relaxed);
+            for (size_t i = 0; i < count; ++i) {
+                const auto* text = static_cast<const Text*>(batch[i].node->getMeasureContext());
+                batch[i].result = textSize(*text, batch[i].constraints.width,
+                                           batch[i].constraints.widthMode);
+            }
+        };
+    }
+};
+
+struct Tree {
+    std::vector<std::unique_ptr<LayoutNode>> nodes;
+    std::vector<std::unique_ptr<Text>> texts;
+
+    LayoutNode* add(LayoutNode* parent) {
+        nodes.push_back(std::make_unique<LayoutNode>());
+        LayoutNode* node = nodes.back().get();
+        if (parent) {
+            parent->addChild(node);
+        }
+        return node;
+    }
+
+    LayoutNode* addText(LayoutNode* parent, float length) {
+        texts.push_back(std::make_unique<Text>(Text{length}));
+        LayoutNode* node = add(parent);
+        node->setMeasureProvider(&kTextProvider, texts.back().get());
+        return node;
+    }
+
+    LayoutNode* addIcon(LayoutNode* parent) {
+        LayoutNode* node = add(parent);
+        node->setMeasureProvider(&kIconProvider, nullptr);
+        return node;
+    }
+
+    LayoutNode* root() const { return nodes.front().get(); }
+};
+
+// A screen of content-sized rows: wrapping text whose height sizes its
+// row, nested columns and a growing spacer
+void buildScreen(Tree& tree) {
+    LayoutNode* root = tree.add(nullptr);
+    root->getStyle().padding[0] = LayoutValue::points(12.0f);
+    root->getStyle().padding[2] = LayoutValue::points(12.0f);
+    root->getStyle().gap = 8.0f;
+    for (int i = 0; i < 12; ++i) {
+        LayoutNode* row = tree.add(root);
+        row->getStyle().flexDirection = FlexDirection::Row;
+        row->getStyle().gap = 6.0f;
+        tree.addIcon(row);
+        LayoutNode* column = tree.add(row);
+        column->getStyle().flexGrow = 1.0f;
+        tree.addText(column, static_cast<float>(8 + i * 9));
+        tree.addText(column, static_cast<float>(30 + (i * 17) % 50));
+        if (i % 3 == 0) {
+            tree.addText(row, 6.0f);
+        }
+    }
+    LayoutNode* spacer = tree.add(root);
+    spacer->getStyle().flexGrow = 1.0f;
+    tree.addText(root, 40.0f);
+}
+
+bool sameFrames(const LayoutNode* a, const LayoutNode* b) {
+    const LayoutResult& la = a->getLayout();
+    const LayoutResult& lb = b->getLayout();
+    if (la.left != lb.left || la.top != lb.top || la.width != lb.width || la.height != lb.height) {
+        return false;
+    }
+    if (a->getChildCount() != b->getChildCount()) {
+        return false;
+    }
+    for (size_t i = 0; i < a->getChildCount(); ++i) {
+        if (!sameFrames(a->getChildren()[i], b->getChildren()[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Synchronous, batched, and batched on a thread pool give the same frames
+void checkFrames() {
+    Tree sync;
+    buildScreen(sync);
+    LayoutEngine::calculateLayout(sync.root(), 360.0f, 1200.0f);
+
+    LayoutThreadPool pool(3);
+    for (bool parallel : {false, true}) {
+        Tree batched;
+        buildScreen(batched);
+        TextBatcher batcher;
+        LayoutOptions options;
+        options.batchMeasure = batcher.func();
+        options.threadPool = parallel ? &pool : nullptr;
+        options.parallelThreshold = 4;
+        LayoutEngine::calculateLayout(batched.root(), 360.0f, 1200.0f, options);
+
+        expect(sameFrames(sync.root(), batched.root()),
+               parallel ? "pooled batched frames match synchronous ones"
+                        : "batched frames match synchronous ones");
+        expect(batcher.calls > 0, "text measured through batchMeasure");
+    }
+}
+
+// root (400x300) -> 3 fixed rows -> 2 text leaves and an icon each. Leaf
+// constraints don't depend on measured sizes, so one round measures all.
+void checkBatchCalls() {
+    Tree tree;
+    LayoutNode* root = tree.add(nullptr);
+    for (int i = 0; i < 3; ++i) {
+        LayoutNode* row = tree.add(root);
+        row->getStyle().flexDirection = FlexDirection::Row;
+        row->getStyle().width = LayoutValue::points(400.0f);
+        row->getStyle().height = LayoutValue::points(40.0f);
+        tree.addText(row, 10.0f);
+        tree.addText(row, 20.0f);
+        tree.addIcon(row);
+    }
+    LayoutNode* edited = tree.nodes[2].get();
+
+    TextBatcher batcher;
+    LayoutOptions options;
+    options.batchMeasure = batcher.func();
+    iconBatchCalls = 0;
+    iconRequests = 0;
+    LayoutEngine::calculateLayout(root, 400.0f, 300.0f, options);
+    expect(batcher.calls == 1, "text batch calls, first pass", batcher.calls, 1);
+    expect(batcher.requests == 6, "text requests, first pass", batcher.requests, 6);
+    expect(iconBatchCalls == 1, "icon batch calls, first pass", iconBatchCalls, 1);
+    expect(iconRequests == 3, "icon requests, first pass", iconRequests, 3);
+
+    // Everything cached: no batch calls
+    root->markDirty();
+    LayoutEngine::calculateLayout(root, 400.0f, 300.0f, options);
+    expect(batcher.calls == 1, "text batch calls, cached pass", batcher.calls, 1);
+    expect(iconBatchCalls == 1, "icon batch calls, cached pass", iconBatchCalls, 1);
+
+    // One changed leaf: one call, one request
+    tree.texts[0]->length = 30.0f;
+    edited->markDirty(DirtyReason::MeasureChanged);
+    LayoutEngine::calculateLayout(root, 400.0f, 300.0f, options);
+    expect(batcher.calls == 2, "text batch calls, one leaf changed", batcher.calls, 2);
+    expect(batcher.requests == 7, "text requests, one leaf changed", batcher.requests, 7);
+
+    // A provider's measureBatch is used without batchMeasure too
+    Tree plain;
+    LayoutNode* plainRoot = plain.add(nullptr);
+    plain.addIcon(plainRoot);
+    plain.addIcon(plainRoot);
+    plain.addText(plainRoot, 10.0f);
+    iconBatchCalls = 0;
+    iconRequests = 0;
+    LayoutEngine::calculateLayout(plainRoot, 400.0f, 300.0f);
+    expect(iconBatchCalls == 1, "icon batch calls without batchMeasure", iconBatchCalls, 1);
+    expect(iconRequests == 2, "icon requests without batchMeasure", iconRequests, 2);
+}
+
+} // namespace
+
+int main() {
+    checkFrames();
+    checkBatchCalls();
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("batch measure checks passed\n");
+    return 0;
+}
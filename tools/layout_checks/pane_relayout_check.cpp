@@ -0,0 +1,67 @@
+/**
+ * Obsidian Layout Check - Pane Relayout
+ *
+ * Regression checks for PaneSolver::layoutChangedPanes: a pane whose
+ * size is unchanged is still laid out when its content changed, including
+ * a change absorbed by a relayout boundary inside the pane.
+ *
+ * Exits non-zero when a check fails.
+ */
+
+#include "core/layout/node.h"
+#include "core/layout/pane_solver.h"
+
+#include <cstdio>
+
+using namespace obsidian::layout;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what, float actual, float expected) {
+    if (!condition) {
+        std::printf("FAIL %s: %g, expected %g\n", what, actual, expected);
+        ++failures;
+    }
+}
+
+// pane root -> box (fixed 50x50, a relayout boundary) -> leaf
+void checkChangeBelowBoundary() {
+    LayoutNode content;
+    LayoutNode box;
+    LayoutNode leaf;
+    box.getStyle().width = LayoutValue::points(50.0f);
+    box.getStyle().height = LayoutValue::points(50.0f);
+    leaf.getStyle().height = LayoutValue::points(10.0f);
+    content.addChild(&box);
+    box.addChild(&leaf);
+
+    PaneSolver solver;
+    solver.setPaneContent(solver.addPane(300.0f), &content);
+    solver.setContainerSize(300.0f, 200.0f);
+    solver.solve();
+    size_t laidOut = solver.layoutChangedPanes();
+    expect(laidOut == 1, "panes laid out first", static_cast<float>(laidOut), 1.0f);
+
+    laidOut = solver.layoutChangedPanes();
+    expect(laidOut == 0, "panes laid out when clean", static_cast<float>(laidOut), 0.0f);
+
+    leaf.getStyle().height = LayoutValue::points(30.0f);
+    leaf.markDirty();
+    laidOut = solver.layoutChangedPanes();
+    expect(laidOut == 1, "panes laid out after a change below a boundary",
+           static_cast<float>(laidOut), 1.0f);
+    expect(leaf.getLayout().height == 30.0f, "leaf height", leaf.getLayout().height, 30.0f);
+}
+
+} // namespace
+
+int main() {
+    checkChangeBelowBoundary();
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("pane relayout checks passed\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * Obsidian Layout Check - Shadow Tree Mounting
+ *
+ * Regression checks for the mutations ShadowTree::commit emits: stacks
+ * with a native view keep their children's views unless the tree
+ * flattens views, and deleting a node removes the views its subtree
+ * mounted into a host above it.
+ *
+ * Exits non-zero when a check fails.
+ */
+
+#include "core/shadow/shadow_node.h"
+#include "core/shadow/shadow_tree.h"
+
+#include <cstdint>
+#include <cstdio>
+
+using namespace obsidian;
+using namespace obsidian::layout;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL %s\n", what);
+        ++failures;
+    }
+}
+
+void* view(uintptr_t id) {
+    return reinterpret_cast<void*>(id);
+}
+
+// Last mutation of a type for a view, or nullptr
+const shadow::ViewMutation* find(const shadow::MutationList& mutations,
+                                 shadow::MutationType type, void* nativeView) {
+    const shadow::ViewMutation* found = nullptr;
+    for (const auto& mutation : mutations) {
+        if (mutation.type == type && mutation.nativeView == nativeView) {
+            found = &mutation;
+        }
+    }
+    return found;
+}
+
+shadow::ShadowNode* createButton(shadow::ShadowTree& tree, uintptr_t id, float height) {
+    shadow::ShadowNode* button = tree.createNode(shadow::ComponentType::Button, view(id));
+    button->getStyle().height = LayoutValue::points(height);
+    return button;
+}
+
+// root -> Button (h=50) + VStack (own view) -> Button (h=20). Without view
+// flattening the stack keeps its view: it gets a frame, and the inner
+// button's frame is relative to it.
+void checkStackViewKeepsChildren() {
+    shadow::ShadowTree tree(1);
+    shadow::MutationList mutations;
+    tree.setMountingCallback([&](const shadow::MutationList& list) { mutations = list; });
+
+    shadow::ShadowNode* stack = tree.createNode(shadow::ComponentType::VStack, view(2));
+    tree.getRootNode()->addChild(createButton(tree, 1, 50.0f));
+    tree.getRootNode()->addChild(stack);
+    stack->addChild(createButton(tree, 3, 20.0f));
+    tree.commit(400.0f, 300.0f);
+
+    const shadow::ViewMutation* stackUpdate = find(mutations, shadow::MutationType::Update, view(2));
+    const shadow::ViewMutation* innerUpdate = find(mutations, shadow::MutationType::Update, view(3));
+    const shadow::ViewMutation* innerInsert = find(mutations, shadow::MutationType::Insert, view(3));
+    expect(stackUpdate && stackUpdate->layoutMetrics.y == 50.0f, "stack view gets its frame");
+    expect(innerUpdate && innerUpdate->layoutMetrics.y == 0.0f, "inner frame relative to the stack");
+    expect(innerInsert && innerInsert->parentView == view(2), "inner view stays in the stack's view");
+
+    // Marked layout-only, a stack with a view still keeps its children
+    stack->setLayoutOnly(true);
+    tree.commit(400.0f, 300.0f);
+    expect(!tree.isFlattened(stack), "layout-only stack with a view is not flattened");
+}
+
+// A layout-only stack without a view is flattened without view flattening
+void checkLayoutOnlyStackFlattened() {
+    shadow::ShadowTree tree(1);
+    shadow::MutationList mutations;
+    tree.setMountingCallback([&](const shadow::MutationList& list) { mutations = list; });
+
+    shadow::ShadowNode* stack = tree.createNode(shadow::ComponentType::VStack);
+    stack->setLayoutOnly(true);
+    tree.getRootNode()->addChild(createButton(tree, 1, 50.0f));
+    tree.getRootNode()->addChild(stack);
+    stack->addChild(createButton(tree, 3, 20.0f));
+    tree.commit(400.0f, 300.0f);
+
+    const shadow::ViewMutation* innerUpdate = find(mutations, shadow::MutationType::Update, view(3));
+    const shadow::ViewMutation* innerInsert = find(mutations, shadow::MutationType::Insert, view(3));
+    expect(tree.isFlattened(stack), "layout-only stack without a view is flattened");
+    expect(innerUpdate && innerUpdate->layoutMetrics.y == 50.0f, "inner frame relative to the root");
+    expect(innerInsert && innerInsert->parentView == nullptr, "inner view mounted in the root view");
+}
+
+// Deleting a flattened stack removes its descendants' views from the host
+void checkDeleteRemovesHostedViews() {
+    shadow::ShadowTree tree(1);
+    tree.setViewFlattening(true);
+    shadow::MutationList mutations;
+    tree.setMountingCallback([&](const shadow::MutationList& list) { mutations = list; });
+
+    shadow::ShadowNode* stack = tree.createNode(shadow::ComponentType::VStack, view(2));
+    tree.getRootNode()->addChild(stack);
+    stack->addChild(createButton(tree, 3, 20.0f));
+    tree.commit(400.0f, 300.0f);
+    expect(tree.isFlattened(stack), "plain stack flattened with view flattening on");
+
+    tree.deleteNode(stack->getTag());
+    mutations.clear();
+    tree.commit(400.0f, 300.0f);
+
+    const shadow::ViewMutation* removal = find(mutations, shadow::MutationType::Remove, view(3));
+    expect(removal && removal->parentView == nullptr, "deleted stack's child removed from the root view");
+}
+
+} // namespace
+
+int main() {
+    checkStackViewKeepsChildren();
+    checkLayoutOnlyStackFlattened();
+    checkDeleteRemovesHostedViews();
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("shadow mounting checks passed\n");
+    return 0;
+}
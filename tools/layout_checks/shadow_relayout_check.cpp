@@ -0,0 +1,128 @@
+/**
+ * Obsidian Layout Check - Shadow Tree Relayout
+ *
+ * Regression checks for ShadowTree::commit's relayout boundary fast
+ * path: a change marked on a node must be laid out by the next commit,
+ * whatever was marked dirty below it before, and once the dirty
+ * boundaries are laid out nothing above them needs layout.
+ *
+ * Exits non-zero when a check fails.
+ */
+
+#include "core/layout/engine.h"
+#include "core/shadow/shadow_node.h"
+#include "core/shadow/shadow_tree.h"
+
+#include <cstdio>
+
+using namespace obsidian;
+using namespace obsidian::layout;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL %s\n", what);
+        ++failures;
+    }
+}
+
+void expect(bool condition, const char* what, float actual, float expected) {
+    if (!condition) {
+        std::printf("FAIL %s: %g, expected %g\n", what, actual, expected);
+        ++failures;
+    }
+}
+
+// root -> A -> B (fixed 100x100, a relayout boundary) -> C. Dirtying C
+// stops at B but flags A shadow-dirty; marking A dirty afterwards must
+// still reach A's layout node.
+void checkAncestorAfterBoundaryChange() {
+    shadow::ShadowTree tree(1);
+    shadow::ShadowNode* a = tree.createNode(shadow::ComponentType::VStack);
+    shadow::ShadowNode* b = tree.createNode(shadow::ComponentType::VStack);
+    shadow::ShadowNode* c = tree.createNode(shadow::ComponentType::VStack);
+    b->getStyle().width = LayoutValue::points(100.0f);
+    b->getStyle().height = LayoutValue::points(100.0f);
+    c->getStyle().height = LayoutValue::points(10.0f);
+    tree.getRootNode()->addChild(a);
+    a->addChild(b);
+    b->addChild(c);
+    tree.commit(500.0f, 400.0f);
+
+    c->getStyle().height = LayoutValue::points(20.0f);
+    c->markDirty();
+    a->getStyle().width = LayoutValue::points(300.0f);
+    a->markDirty();
+    tree.commit(500.0f, 400.0f);
+
+    expect(a->getLayoutMetrics().width == 300.0f, "ancestor width after boundary change",
+           a->getLayoutMetrics().width, 300.0f);
+    expect(c->getLayoutMetrics().height == 20.0f, "boundary content height",
+           c->getLayoutMetrics().height, 20.0f);
+}
+
+// root -> A -> two fixed 100x100 boxes (relayout boundaries) -> a leaf
+// each. Laying out dirty boxes on their own clears the flags above them
+// once none is left.
+void checkAncestorsCleanAfterBoundaries() {
+    shadow::ShadowTree tree(1);
+    shadow::ShadowNode* a = tree.createNode(shadow::ComponentType::VStack);
+    shadow::ShadowNode* boxes[2];
+    shadow::ShadowNode* leaves[2];
+    tree.getRootNode()->addChild(a);
+    for (int i = 0; i < 2; ++i) {
+        boxes[i] = tree.createNode(shadow::ComponentType::VStack);
+        boxes[i]->getStyle().width = LayoutValue::points(100.0f);
+        boxes[i]->getStyle().height = LayoutValue::points(100.0f);
+        leaves[i] = tree.createNode(shadow::ComponentType::VStack);
+        leaves[i]->getStyle().height = LayoutValue::points(10.0f);
+        a->addChild(boxes[i]);
+        boxes[i]->addChild(leaves[i]);
+    }
+    tree.commit(500.0f, 400.0f);
+    LayoutNode* root = tree.getRootNode()->getLayoutNode();
+
+    leaves[0]->getStyle().height = LayoutValue::points(20.0f);
+    leaves[0]->markDirty();
+    expect(root->needsLayout(), "root needs layout after a change below a boundary");
+    tree.commit(500.0f, 400.0f);
+    expect(leaves[0]->getLayoutMetrics().height == 20.0f, "leaf height after boundary commit",
+           leaves[0]->getLayoutMetrics().height, 20.0f);
+    expect(!root->needsLayout(), "root clean after boundary commit");
+    expect(!a->getLayoutNode()->needsLayout(), "ancestor clean after boundary commit");
+
+    // With both boxes dirty, the ancestors stay flagged until both are done
+    for (int i = 0; i < 2; ++i) {
+        leaves[i]->getStyle().height = LayoutValue::points(30.0f);
+        leaves[i]->getLayoutNode()->markDirty();
+    }
+    expect(LayoutEngine::layoutBoundary(boxes[0]->getLayoutNode()), "first box laid out alone");
+    expect(root->needsLayout(), "root flagged while the second box is dirty");
+    expect(LayoutEngine::layoutBoundary(boxes[1]->getLayoutNode()), "second box laid out alone");
+    expect(!root->needsLayout(), "root clean after both boxes");
+    expect(!a->getLayoutNode()->needsLayout(), "ancestor clean after both boxes");
+
+    // A later change below a box is flagged up to the root again
+    leaves[1]->getStyle().height = LayoutValue::points(40.0f);
+    leaves[1]->markDirty();
+    expect(root->needsLayout(), "root flagged by a later change");
+    tree.commit(500.0f, 400.0f);
+    expect(leaves[1]->getLayoutMetrics().height == 40.0f, "leaf height after a later change",
+           leaves[1]->getLayoutMetrics().height, 40.0f);
+    expect(!root->needsLayout(), "root clean after a later change");
+}
+
+} // namespace
+
+int main() {
+    checkAncestorAfterBoundaryChange();
+    checkAncestorsCleanAfterBoundaries();
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("shadow relayout checks passed\n");
+    return 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * Obsidian Layout Check - Steady-State Allocations
+ *
+ * Counts heap allocations with a replaced global operator new while
+ * laying out trees whose shape doesn't change: once warmed up, a layout
+ * pass must not allocate, whether every node was marked dirty or the
+ * available size changed. Covers flex (all directions, wrapping content,
+ * percentages, absolute children, measured leaves) and grid containers,
+ * over both LayoutNode trees and LayoutTree.
+ *
+ * Exits non-zero when a pass allocates.
+ */
+
+#include "core/layout/engine.h"
+#include "core/layout/layout_tree.h"
+#include "core/layout/node.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<size_t> allocations{0};
+
+void* allocate(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = ((size ? size : 1) + align - 1) / align * align;
+    if (void* p = std::aligned_alloc(align, rounded)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+using namespace obsidian::layout;
+
+namespace {
+
+int failures = 0;
+
+// Allocations made by `fn`
+template <typename Fn>
+size_t countAllocations(Fn&& fn) {
+    allocations = 0;
+    counting = true;
+    fn();
+    counting = false;
+    return allocations;
+}
+
+void expectNone(const char* what, size_t count) {
+    if (count != 0) {
+        std::printf("FAIL %s: %zu allocations\n", what, count);
+        ++failures;
+    }
+}
+
+Size measureText(float width, MeasureMode widthMode, float /* height */, MeasureMode /* heightMode */) {
+    // Wraps to the width it is offered
+    float natural = 180.0f;
+    if (widthMode != MeasureMode::Undefined && width < natural) {
+        float lines = (width > 1.0f) ? natural / width : natural;
+        return {width, 18.0f * static_cast<float>(static_cast<int>(lines) + 1)};
+    }
+    return {natural, 18.0f};
+}
+
+// Style of the `index`th node, cycling through the features a pass
+// goes through
+Style styleFor(size_t index) {
+    static const FlexDirection kDirections[] = {
+        FlexDirection::Column, FlexDirection::Row,
+        FlexDirection::ColumnReverse, FlexDirection::RowReverse,
+    };
+    Style style;
+    style.flexDirection = kDirections[index % 4];
+    style.justifyContent = static_cast<JustifyContent>(index % 6);
+    style.alignItems = static_cast<AlignItems>(index % 4);
+    style.gap = static_cast<float>(index % 3) * 4.0f;
+    style.padding[0] = LayoutValue::points(4.0f);
+    style.padding[1] = LayoutValue::points(2.0f);
+    if (index % 5 == 1) style.flexGrow = 1.0f;
+    if (index % 7 == 2) style.width = LayoutValue::percent(40.0f);
+    if (index % 11 == 3) style.minHeight = LayoutValue::points(30.0f);
+    if (index % 13 == 4) {
+        style.positionType = PositionType::Absolute;
+        style.position[0] = LayoutValue::points(8.0f);
+        style.position[1] = LayoutValue::points(8.0f);
+    }
+    return style;
+}
+
+Style gridStyle() {
+    Style style;
+    style.display = Display::Grid;
+    style.gridColumns = GridTracks{GridTrack::points(80.0f), GridTrack::fraction(1.0f), GridTrack::auto_()};
+    style.gap = 6.0f;
+    return style;
+}
+
+// A screen-like LayoutNode tree: `fanout` children per container, down
+// to measured leaves at `depth`, with a grid container in every other
+// level
+class NodeTree {
+public:
+    NodeTree(size_t depth, size_t fanout) {
+        root_ = add(styleFor(0));
+        build(root_, depth, fanout);
+    }
+
+    ~NodeTree() {
+        for (auto& node : nodes_) node->removeAllChildren();
+    }
+
+    LayoutNode* root() { return root_; }
+
+    void markAllDirty() {
+        for (auto& node : nodes_) node->markDirty();
+    }
+
+private:
+    LayoutNode* add(const Style& style) {
+        nodes_.push_back(std::make_unique<LayoutNode>());
+        nodes_.back()->setStyle(style);
+        return nodes_.back().get();
+    }
+
+    void build(LayoutNode* parent, size_t depth, size_t fanout) {
+        for (size_t i = 0; i < fanout; ++i) {
+            if (depth == 0) {
+                LayoutNode* leaf = add(Style{});
+                leaf->setMeasureFunc(measureText);
+                parent->addChild(leaf);
+                continue;
+            }
+            bool grid = (depth % 2 == 0) && i == 0;
+            LayoutNode* child = add(grid ? gridStyle() : styleFor(nodes_.size()));
+            parent->addChild(child);
+            build(child, depth - 1, fanout);
+        }
+    }
+
+    std::vector<std::unique_ptr<LayoutNode>> nodes_;
+    LayoutNode* root_ = nullptr;
+};
+
+void checkNodeTree() {
+    NodeTree tree(4, 4);
+    LayoutNode* root = tree.root();
+
+    // Warm-up: interning, thread-local scratch, grid track tables
+    LayoutEngine::calculateLayout(root, 1024.0f, 768.0f);
+    LayoutEngine::calculateLayout(root, 800.0f, 600.0f);
+
+    tree.markAllDirty();
+    expectNone("LayoutNode tree, all dirty", countAllocations([&] {
+        LayoutEngine::calculateLayout(root, 800.0f, 600.0f);
+    }));
+    expectNone("LayoutNode tree, resized", countAllocations([&] {
+        LayoutEngine::calculateLayout(root, 1024.0f, 768.0f);
+        LayoutEngine::calculateLayout(root, 800.0f, 600.0f);
+    }));
+    expectNone("LayoutNode tree, clean", countAllocations([&] {
+        LayoutEngine::calculateLayout(root, 800.0f, 600.0f);
+    }));
+}
+
+void buildLayoutTree(LayoutTree& tree, NodeId parent, size_t depth, size_t fanout) {
+    for (size_t i = 0; i < fanout; ++i) {
+        NodeId child = tree.createNode(depth == 0 ? Style{} : styleFor(tree.size()));
+        if (depth == 0) {
+            tree.setMeasureFunc(child, measureText);
+        }
+        tree.appendChild(parent, child);
+        if (depth > 0) {
+            buildLayoutTree(tree, child, depth - 1, fanout);
+        }
+    }
+}
+
+void checkLayoutTree() {
+    LayoutTree tree;
+    NodeId root = tree.createNode(styleFor(0));
+    buildLayoutTree(tree, root, 4, 4);
+
+    LayoutEngine::calculateLayout(tree, root, 1024.0f, 768.0f);
+    LayoutEngine::calculateLayout(tree, root, 800.0f, 600.0f);
+
+    expectNone("LayoutTree", countAllocations([&] {
+        LayoutEngine::calculateLayout(tree, root, 1024.0f, 768.0f);
+        LayoutEngine::calculateLayout(tree, root, 800.0f, 600.0f);
+    }));
+}
+
+} // namespace
+
+int main() {
+    checkNodeTree();
+    checkLayoutTree();
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("steady-state layout allocates nothing\n");
+    return 0;
+}
@@ -39,6 +39,7 @@ namespace obsidian {
 // Forward declare FFI functions for layout engine
 #ifdef __APPLE__
 extern "C" void obsidian_macos_view_set_frame(void* view, double x, double y, double width, double height);
+extern "C" void obsidian_macos_view_set_frames(const layout::ViewFrame* frames, size_t count);
 extern "C" void obsidian_macos_view_get_bounds(void* view, double* x, double* y, double* w, double* h);
 #endif
 
@@ -56,8 +57,9 @@ public:
     
     // Layout Engine integration
     // IMPORTANT: layoutNode ownership model (inspired by React Native's Shadow Tree)
-    // - When an HStack is created, it owns its layoutNode
-    // - When an HStack is added as a child to another container, ownership transfers
+    // - An HStack owns its layoutNode for as long as it exists
+    // - If it is destroyed while in another container, ownership transfers
+    //   to the container's node
     // - This ensures layoutNodes persist even when component objects go out of scope
     layout::ViewNode* layoutNode;
     std::vector<layout::LayoutNode*> childLayoutNodes;
@@ -77,9 +79,14 @@ public:
     {}
     
     ~Impl() {
-        // Only delete layoutNode if we still own it
-        if (ownsLayoutNode && layoutNode) {
-            delete layoutNode;
+        if (!ownsLayoutNode || !layoutNode) return;
+        
+        if (layoutNode->getParent()) {
+            // Hand the node to its container, so the layout outlives this object
+            layoutNode->setOwnedByParent(true);
+        } else {
+            // Frees the child nodes created by addChild(); nested stacks keep theirs
+            layout::ViewNode::destroy(layoutNode);
         }
     }
 };
@@ -100,6 +107,9 @@ HStack::HStack() : pImpl(std::make_unique<Impl>()) {
         layout::ViewNode::setSetFrameCallback([](void* view, float x, float y, float w, float h) {
             obsidian_macos_view_set_frame(view, x, y, w, h);
         });
+        layout::ViewNode::setApplyFramesCallback([](const layout::ViewFrame* frames, size_t count) {
+            obsidian_macos_view_set_frames(frames, count);
+        });
     }
 #endif
 }
@@ -127,7 +137,7 @@ void HStack::setSpacing(double spacing) {
             // Update layout node
             if (pImpl->layoutNode) {
                 pImpl->layoutNode->getStyle().gap = static_cast<float>(spacing);
-                pImpl->layoutNode->markDirty();
+                pImpl->layoutNode->markDirty(layout::DirtyReason::StyleChanged);
             }
 #endif
         }
@@ -164,7 +174,7 @@ void HStack::setPadding(const Padding& padding) {
                 style.padding[1] = layout::LayoutValue::points(static_cast<float>(padding.top));
                 style.padding[2] = layout::LayoutValue::points(static_cast<float>(padding.trailing));
                 style.padding[3] = layout::LayoutValue::points(static_cast<float>(padding.bottom));
-                pImpl->layoutNode->markDirty();
+                pImpl->layoutNode->markDirty(layout::DirtyReason::StyleChanged);
             }
 #endif
         }
@@ -206,7 +216,7 @@ void HStack::addChild(Button& button) {
         auto* childNode = layout::ViewNode::createLeaf(buttonView, nullptr);
         childNode->getStyle().width = layout::LayoutValue::points(100.0f);  // Default button width
         childNode->getStyle().height = layout::LayoutValue::points(30.0f);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
         pImpl->childLayoutNodes.push_back(childNode);
     }
 #endif
@@ -239,7 +249,7 @@ void HStack::addChild(Spacer& spacer) {
     // Create LayoutNode for spacer (uses flexGrow to fill available space)
     if (pImpl->layoutNode) {
         auto* childNode = layout::ViewNode::createSpacer(spacerView);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
         pImpl->childLayoutNodes.push_back(childNode);
     }
 #endif
@@ -276,7 +286,7 @@ void HStack::addChild(Link& link) {
         auto* childNode = layout::ViewNode::createLeaf(linkView, nullptr);
         childNode->getStyle().width = layout::LayoutValue::points(80.0f);  // Default link width
         childNode->getStyle().height = layout::LayoutValue::points(30.0f);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
         pImpl->childLayoutNodes.push_back(childNode);
     }
 #endif
@@ -326,7 +336,7 @@ void HStack::addChild(TextView& textView) {
         auto* childNode = layout::ViewNode::createLeaf(textViewHandle, nullptr);
         childNode->getStyle().flexGrow = 1.0f;  // Text views expand to fill
         childNode->getStyle().height = layout::LayoutValue::points(textHeight);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
         pImpl->childLayoutNodes.push_back(childNode);
     }
 #endif
@@ -353,9 +363,6 @@ void HStack::addChild(VStack& vstack) {
     if (pImpl->layoutNode) {
         auto* childLayoutNode = static_cast<layout::LayoutNode*>(vstack.getLayoutNode());
         if (childLayoutNode) {
-            // Transfer ownership
-            vstack.releaseLayoutNodeOwnership();
-            
             // Add to layout tree
             pImpl->layoutNode->addChild(childLayoutNode);
             pImpl->childLayoutNodes.push_back(childLayoutNode);
@@ -385,9 +392,6 @@ void HStack::addChild(HStack& hstack) {
     if (pImpl->layoutNode) {
         auto* childLayoutNode = static_cast<layout::LayoutNode*>(hstack.getLayoutNode());
         if (childLayoutNode) {
-            // Transfer ownership
-            hstack.releaseLayoutNodeOwnership();
-            
             // Add to layout tree
             pImpl->layoutNode->addChild(childLayoutNode);
             pImpl->childLayoutNodes.push_back(childLayoutNode);
@@ -520,6 +524,11 @@ void HStack::clearChildren() {
         obsidian_macos_hstack_remove_child_view(pImpl->hstackHandle, childView);
     }
     pImpl->childViewHandles.clear();
+    
+    if (pImpl->layoutNode) {
+        pImpl->layoutNode->destroyChildren();
+    }
+    pImpl->childLayoutNodes.clear();
 #endif
 }
 
@@ -38,6 +38,7 @@ namespace obsidian {
 // Forward declare FFI functions for layout engine
 #ifdef __APPLE__
 extern "C" void obsidian_macos_view_set_frame(void* view, double x, double y, double width, double height);
+extern "C" void obsidian_macos_view_set_frames(const layout::ViewFrame* frames, size_t count);
 extern "C" void obsidian_macos_view_get_bounds(void* view, double* x, double* y, double* w, double* h);
 #endif
 
@@ -57,8 +58,14 @@ public:
     bool ownsLayoutNode = true;
     
     ~Impl() {
-        if (ownsLayoutNode && layoutNode) {
-            delete layoutNode;
+        if (!ownsLayoutNode || !layoutNode) return;
+        
+        if (layoutNode->getParent()) {
+            // Hand the node to its container, so the layout outlives this object
+            layoutNode->setOwnedByParent(true);
+        } else {
+            // Frees the child nodes created by addChild(); nested stacks keep theirs
+            layout::ViewNode::destroy(layoutNode);
         }
     }
     
@@ -161,7 +168,7 @@ public:
                 break;
         }
         
-        layoutNode->markDirty();
+        layoutNode->markDirty(layout::DirtyReason::StyleChanged);
     }
     
     layout::LayoutNode* findRootLayoutNode() {
@@ -200,6 +207,9 @@ VStack::VStack() : pImpl(std::make_unique<Impl>()) {
             layout::ViewNode::setSetFrameCallback([](void* view, float x, float y, float w, float h) {
                 obsidian_macos_view_set_frame(view, x, y, w, h);
             });
+            layout::ViewNode::setApplyFramesCallback([](const layout::ViewFrame* frames, size_t count) {
+                obsidian_macos_view_set_frames(frames, count);
+            });
             callbackSet = true;
         }
     }
@@ -230,7 +240,7 @@ void VStack::setSpacing(double spacing) {
             // Update layout node
             if (pImpl->layoutNode) {
                 pImpl->layoutNode->getStyle().gap = static_cast<float>(spacing);
-                pImpl->layoutNode->markDirty();
+                pImpl->layoutNode->markDirty(layout::DirtyReason::StyleChanged);
             }
 #endif
         }
@@ -275,7 +285,7 @@ void VStack::setPadding(const Padding& padding) {
                 style.padding[1] = layout::LayoutValue::points(static_cast<float>(padding.top));
                 style.padding[2] = layout::LayoutValue::points(static_cast<float>(padding.trailing));
                 style.padding[3] = layout::LayoutValue::points(static_cast<float>(padding.bottom));
-                pImpl->layoutNode->markDirty();
+                pImpl->layoutNode->markDirty(layout::DirtyReason::StyleChanged);
             }
 #endif
         }
@@ -304,7 +314,7 @@ void VStack::addChild(Button& button) {
     if (pImpl->layoutNode) {
         auto* childNode = layout::ViewNode::createLeaf(buttonView, nullptr);
         childNode->getStyle().height = layout::LayoutValue::points(30.0f);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
     }
 #endif
 }
@@ -324,7 +334,7 @@ void VStack::addChild(Spacer& spacer) {
     
     if (pImpl->layoutNode) {
         auto* childNode = layout::ViewNode::createSpacer(spacerView);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
     }
 #endif
 }
@@ -347,7 +357,7 @@ void VStack::addChild(Link& link) {
     if (pImpl->layoutNode) {
         auto* childNode = layout::ViewNode::createLeaf(linkView, nullptr);
         childNode->getStyle().height = layout::LayoutValue::points(30.0f);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
     }
 #endif
 }
@@ -380,7 +390,7 @@ void VStack::addChild(TextView& textView) {
         
         auto* childNode = layout::ViewNode::createLeaf(textViewHandle, nullptr);
         childNode->getStyle().height = layout::LayoutValue::points(textHeight);
-        pImpl->layoutNode->addChild(childNode);
+        pImpl->layoutNode->adoptChild(childNode);
     }
 #endif
 }
@@ -401,7 +411,6 @@ void VStack::addChild(VStack& vstack) {
     if (pImpl->layoutNode) {
         auto* childLayoutNode = static_cast<layout::LayoutNode*>(vstack.getLayoutNode());
         if (childLayoutNode) {
-            vstack.releaseLayoutNodeOwnership();
             pImpl->layoutNode->addChild(childLayoutNode);
         }
     }
@@ -430,7 +439,6 @@ void VStack::addChild(HStack& hstack) {
     if (pImpl->layoutNode) {
         auto* childLayoutNode = static_cast<layout::LayoutNode*>(hstack.getLayoutNode());
         if (childLayoutNode) {
-            hstack.releaseLayoutNodeOwnership();
             pImpl->layoutNode->addChild(childLayoutNode);
         }
     }
@@ -563,7 +571,7 @@ void VStack::clearChildren() {
     pImpl->childViewHandles.clear();
     
     if (pImpl->layoutNode) {
-        pImpl->layoutNode->removeAllChildren();
+        pImpl->layoutNode->destroyChildren();
     }
 #endif
 }
@@ -620,7 +628,6 @@ void VStack::addToParentView(void* parentView) {
         if (parentLayoutNodePtr) {
             auto* parentNode = static_cast<layout::LayoutNode*>(parentLayoutNodePtr);
             parentNode->addChild(pImpl->layoutNode);
-            releaseLayoutNodeOwnership();
             pImpl->recalculateLayoutFromRoot(parentView);
         }
     }